@@ -0,0 +1,257 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "AddressIndex.h"
+#include "DemangleUtil.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define PREFETCH(address) __builtin_prefetch(address)
+#endif
+
+namespace
+{
+    struct SymbolRange
+    {
+        uint32_t start;
+        uint32_t size;
+        // The end address of the section that contains the symbol.
+        uint64_t sectionEnd;
+        std::string_view name;
+    };
+
+    void BuildEytzinger(
+        const std::vector<uint32_t>& sorted,
+        std::vector<uint32_t>& eytzinger,
+        std::vector<uint32_t>& eytzingerToSorted,
+        size_t& sortedIndex,
+        size_t k)
+    {
+        if (k < eytzinger.size())
+        {
+            BuildEytzinger(sorted, eytzinger, eytzingerToSorted, sortedIndex, 2 * k);
+            eytzingerToSorted[k] = static_cast<uint32_t>(sortedIndex);
+            eytzinger[k] = sorted[sortedIndex++];
+            BuildEytzinger(sorted, eytzinger, eytzingerToSorted, sortedIndex, 2 * k + 1);
+        }
+    }
+}
+
+AddressIndex::AddressIndex(const ElfSymbolReader& reader)
+{
+    const std::vector<ElfSection>& sections = reader.GetSections();
+    std::vector<SymbolRange> ranges;
+
+    for (const ElfSymbol& symbol : reader.GetSymbols())
+    {
+        // Only the symbols that are defined in a section have an address.
+        if ((symbol.type == ElfSymbolType::Function || symbol.type == ElfSymbolType::Object || symbol.type == ElfSymbolType::NoType)
+            && !symbol.sectionName.empty())
+        {
+            const ElfSection& section = sections[symbol.sectionIndex];
+
+            ranges.push_back(SymbolRange{ symbol.value, symbol.size, static_cast<uint64_t>(section.address) + section.size, symbol.name });
+        }
+    }
+
+    // When several symbols share an address the one with the largest size is used.
+    std::stable_sort(ranges.begin(), ranges.end(), [](const SymbolRange& a, const SymbolRange& b)
+    {
+        return a.start < b.start || (a.start == b.start && a.size > b.size);
+    });
+    ranges.erase(
+        std::unique(ranges.begin(), ranges.end(), [](const SymbolRange& a, const SymbolRange& b) { return a.start == b.start; }),
+        ranges.end());
+
+    const size_t count = ranges.size();
+
+    starts.reserve(count);
+    ends.reserve(count);
+    mangledNames.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const SymbolRange& range = ranges[i];
+        uint32_t end = range.start + range.size;
+
+        if (range.size == 0)
+        {
+            // Symbols without a size (e.g. from assembly code) extend to the start of the next symbol,
+            // but not past the end of their own section, the next symbol can be in another section.
+            const uint64_t nextStart = i + 1 < count ? ranges[i + 1].start : static_cast<uint64_t>(range.start) + 1;
+            const uint64_t clampedEnd = std::min(nextStart, range.sectionEnd);
+
+            end = clampedEnd > range.start ? static_cast<uint32_t>(std::min<uint64_t>(clampedEnd, UINT32_MAX)) : range.start + 1;
+        }
+
+        starts.push_back(range.start);
+        ends.push_back(end);
+        mangledNames.push_back(range.name);
+    }
+
+    eytzingerStarts.resize(count + 1);
+    eytzingerToSorted.resize(count + 1);
+
+    size_t sortedIndex = 0;
+    BuildEytzinger(starts, eytzingerStarts, eytzingerToSorted, sortedIndex, 1);
+
+    demangledNames = std::make_unique<std::atomic<const std::string*>[]>(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        demangledNames[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+AddressIndex::~AddressIndex()
+{
+    for (size_t i = 0; i < starts.size(); i++)
+    {
+        delete demangledNames[i].load(std::memory_order_relaxed);
+    }
+}
+
+size_t AddressIndex::FindSorted(uint32_t address) const noexcept
+{
+    // Find the first start address that is greater than the address, the symbol that may
+    // contain the address is the one before it.
+    const uint32_t* const data = eytzingerStarts.data();
+    const size_t n = starts.size();
+    size_t k = 1;
+
+    while (k <= n)
+    {
+        // The 16 descendants that are four levels below k are stored in one 64 byte cache line.
+        PREFETCH(data + (k * 16));
+        k = 2 * k + (data[k] <= address ? 1 : 0);
+    }
+
+    // Remove the right turns that followed the last left turn.
+    k >>= std::countr_one(k) + 1;
+
+    const size_t upperBound = k == 0 ? n : eytzingerToSorted[k];
+
+    return upperBound == 0 ? NotFound : upperBound - 1;
+}
+
+size_t AddressIndex::Find(uint32_t address) const noexcept
+{
+    const size_t index = FindSorted(address);
+
+    if (index == NotFound || address >= ends[index])
+    {
+        return NotFound;
+    }
+
+    return index;
+}
+
+void AddressIndex::FindBatch(const uint32_t* addresses, size_t count, size_t* results) const noexcept
+{
+    // The linear pass is only used when there are enough addresses to make it cheaper than a search per address.
+    if (count >= (starts.size() / 16) && std::is_sorted(addresses, addresses + count))
+    {
+        // Walk the symbols and the addresses together.
+        const size_t symbolCount = starts.size();
+        size_t symbol = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t address = addresses[i];
+
+            while (symbol < symbolCount && starts[symbol] <= address)
+            {
+                symbol++;
+            }
+
+            // The symbol before the first start address that is greater than the address.
+            if (symbol == 0 || address >= ends[symbol - 1])
+            {
+                results[i] = NotFound;
+            }
+            else
+            {
+                results[i] = symbol - 1;
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            results[i] = Find(addresses[i]);
+        }
+    }
+}
+
+size_t AddressIndex::GetSymbolCount() const noexcept
+{
+    return starts.size();
+}
+
+uint32_t AddressIndex::GetStartAddress(size_t index) const noexcept
+{
+    return starts[index];
+}
+
+uint32_t AddressIndex::GetEndAddress(size_t index) const noexcept
+{
+    return ends[index];
+}
+
+std::string_view AddressIndex::GetMangledName(size_t index) const noexcept
+{
+    return mangledNames[index];
+}
+
+std::string_view AddressIndex::GetDemangledName(size_t index) const
+{
+    const std::string* name = demangledNames[index].load(std::memory_order_acquire);
+
+    if (!name)
+    {
+        std::string demangled;
+
+        // The names are null-terminated views into the ELF string table.
+        if (!TryDemangle(mangledNames[index].data(), DemangleFormat::Classic, demangled))
+        {
+            demangled.assign(mangledNames[index]);
+        }
+
+        const std::string* newName = new std::string(std::move(demangled));
+
+        // If another thread demangled the name first its copy is used.
+        if (demangledNames[index].compare_exchange_strong(name, newName, std::memory_order_acq_rel))
+        {
+            name = newName;
+        }
+        else
+        {
+            delete newName;
+        }
+    }
+
+    return *name;
+}
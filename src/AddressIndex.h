@@ -0,0 +1,76 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ElfSymbolReader.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Maps addresses to the function or object symbol that contains them.
+// The start addresses are stored in Eytzinger (breadth-first) order, which keeps the first levels of
+// the binary search in a few cache lines, and the symbol data is kept in separate arrays.
+// The demangled names are created the first time they are requested.
+class AddressIndex
+{
+public:
+    static constexpr size_t NotFound = SIZE_MAX;
+
+    // The index refers to the symbol names in the reader, it must outlive the index.
+    explicit AddressIndex(const ElfSymbolReader& reader);
+    ~AddressIndex();
+
+    AddressIndex(const AddressIndex&) = delete;
+    AddressIndex& operator=(const AddressIndex&) = delete;
+
+    // Returns the index of the symbol that contains the address, or NotFound.
+    // When symbols overlap, only the one with the nearest start address is considered.
+    size_t Find(uint32_t address) const noexcept;
+
+    // Looks up each address and stores the symbol index (or NotFound) in the results array.
+    // A large batch of sorted addresses is resolved in a single linear pass over the symbols.
+    void FindBatch(const uint32_t* addresses, size_t count, size_t* results) const noexcept;
+
+    size_t GetSymbolCount() const noexcept;
+    uint32_t GetStartAddress(size_t index) const noexcept;
+    uint32_t GetEndAddress(size_t index) const noexcept;
+    std::string_view GetMangledName(size_t index) const noexcept;
+
+    // Returns the demangled name, or the mangled name if it cannot be demangled.
+    // This is safe to call from multiple threads.
+    std::string_view GetDemangledName(size_t index) const;
+
+private:
+    size_t FindSorted(uint32_t address) const noexcept;
+
+    // The Eytzinger layout starts at index 1, each entry also stores its sorted position.
+    std::vector<uint32_t> eytzingerStarts;
+    std::vector<uint32_t> eytzingerToSorted;
+    // The symbol data in address order.
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> ends;
+    std::vector<std::string_view> mangledNames;
+    std::unique_ptr<std::atomic<const std::string*>[]> demangledNames;
+};
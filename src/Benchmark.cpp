@@ -0,0 +1,445 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "Benchmark.h"
+#include "AddressIndex.h"
+#include "DemangleUtil.h"
+#include "ElfSymbolReader.h"
+#include "HardwareCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "demangle.h"
+}
+
+namespace
+{
+    template <typename Function> double MeasureSeconds(Function&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    struct LookupMeasurement
+    {
+        double seconds;
+        HardwareCounterValues counters;
+    };
+
+    template <typename Function> LookupMeasurement MeasureLookups(HardwareCounters& hardwareCounters, Function&& function)
+    {
+        hardwareCounters.Start();
+        const double seconds = MeasureSeconds(function);
+
+        return LookupMeasurement{ seconds, hardwareCounters.Stop() };
+    }
+
+    void PrintRate(const char* name, size_t count, const LookupMeasurement& measurement)
+    {
+        std::cout << name << ": " << static_cast<uint64_t>(static_cast<double>(count) / measurement.seconds) << " lookups/s ("
+                  << (measurement.seconds * 1e9 / static_cast<double>(count)) << " ns/lookup)" << std::endl;
+        WriteHardwareCounters(std::cout, measurement.counters, static_cast<double>(count), "lookup");
+    }
+
+    struct SymbolCategory
+    {
+        const char* name;
+        std::vector<const char*> symbols;
+    };
+
+    struct StageBenchmark
+    {
+        const char* name;
+        int stage;
+        // Each input starts at the construct that the stage parses.
+        std::vector<const char*> inputs;
+    };
+
+    const std::vector<SymbolCategory> SymbolCategories
+    {
+        {
+            "plain methods",
+            {
+                "Foo__9cRZSampleiPCcRUl",
+                "GetName__C9cRZSample",
+                "SetValue__12cRZParameterRC9cRZString",
+                "Init__11cSC3AppImplPvUiT2",
+            }
+        },
+        {
+            "thunks",
+            {
+                "__thunk_8_Baz__3FooRCQ23Foo3Bar",
+                "__thunk_4_QueryInterface__9cRZSampleUlPPv",
+            }
+        },
+        {
+            "vtables and specials",
+            {
+                "_vt$9cRZSample",
+                "_vt$3Foo$3Bar",
+                "__vt_9cRZSample",
+                "_GLOBAL_$I$Foo",
+                "_9cRZSample$s_instance",
+            }
+        },
+        {
+            "operators",
+            {
+                "__ls__FR7ostreamRC9cRZString",
+                "__eq__C9cRZStringRC9cRZString",
+                "__as__9cRZSampleRC9cRZSample",
+                "__vc__C6vectorUi",
+                "__nw__FUi",
+                "__opi__C8cRZFloat",
+            }
+        },
+        {
+            "templates",
+            {
+                "__t6vector1Zi",
+                "__t4pair2Z9cRZStringZi",
+                "push_back__t6vector2ZPvZt9allocator1ZPvRCPv",
+                "begin__t3map4Z9cRZStringZiZt4less1Z9cRZStringZt9allocator1Zi",
+            }
+        },
+        {
+            "squangled K/B",
+            {
+                "f__FQ21A1BQ21A1CK0",
+                "g__FQ21A1BB0",
+                "Get__Q311cRZBaseList8iterator4NodeRCB0",
+                "Set__Q311cRZBaseList8iterator4NodePQ311cRZBaseList8iterator4NodeK1",
+            }
+        },
+        {
+            "deep Q qualification",
+            {
+                "Method__Q53Foo3Bar3Baz3Qux4QuuxiPCc",
+                "_$_Q43Foo3Bar3Baz3Qux",
+                "Get__Q311cRZBaseList8iterator4NodeRCQ311cRZBaseList8iterator4Node",
+                "Draw__C8cSC3ViewPQ39cSC3World7Terrain4CellRCQ39cSC3World7Terrain4Cell",
+            }
+        },
+    };
+
+    const std::vector<StageBenchmark> StageBenchmarks
+    {
+        { "demangle_prefix", demangle_stage_prefix, { "Foo__9cRZSampleiPCcRUl", "__as__9cRZSampleRC9cRZSample", "__t6vector1Zi" } },
+        { "gnu_special", demangle_stage_gnu_special, { "_vt$9cRZSample", "__thunk_8_Baz__3FooRCQ23Foo3Bar", "_9cRZSample$s_instance" } },
+        { "demangle_qualified", demangle_stage_qualified, { "Q23Foo3Bar", "Q53Foo3Bar3Baz3Qux4Quux", "Q311cRZBaseList8iterator4Node" } },
+        { "do_type", demangle_stage_type, { "PCc", "RC9cRZString", "PFi_v", "Q311cRZBaseList8iterator4Node" } },
+        { "demangle_template", demangle_stage_template, { "t6vector1Zi", "t4pair2Z9cRZStringZi", "t3map4Z9cRZStringZiZt4less1Z9cRZStringZt9allocator1Zi" } },
+        { "demangle_args", demangle_stage_args, { "iPCcRUl", "RC9cRZStringUiT1", "PvUiN21", "iPCcRUlPFi_vT2" } },
+        { "string_* helpers", demangle_stage_strings, { "cRZSample", "cRZBaseList::iterator::Node" } },
+    };
+
+    constexpr int DemangleOptions = DMGL_PARAMS | DMGL_ANSI;
+    constexpr int RepeatCount = 5;
+
+    struct SymbolMeasurement
+    {
+        double nanosecondsPerSymbol;
+        double calls;
+        // The hardware counters of the fastest run.
+        HardwareCounterValues counters;
+    };
+
+    // Runs the benchmark several times and returns the fastest run, which is the least disturbed by other processes.
+    template <typename Function> SymbolMeasurement MeasureSymbols(HardwareCounters& hardwareCounters, size_t symbolCount, size_t iterations, Function&& function)
+    {
+        double bestSeconds = 0;
+        HardwareCounterValues bestCounters;
+
+        for (int repeat = 0; repeat < RepeatCount; repeat++)
+        {
+            hardwareCounters.Start();
+
+            const double seconds = MeasureSeconds([&]()
+            {
+                for (size_t i = 0; i < iterations; i++)
+                {
+                    function();
+                }
+            });
+
+            const HardwareCounterValues counters = hardwareCounters.Stop();
+
+            if (repeat == 0 || seconds < bestSeconds)
+            {
+                bestSeconds = seconds;
+                bestCounters = counters;
+            }
+        }
+
+        const double calls = static_cast<double>(symbolCount * iterations);
+
+        return SymbolMeasurement{ bestSeconds * 1e9 / calls, calls, bestCounters };
+    }
+
+    void PrintMeasurement(const std::string& name, const SymbolMeasurement& measurement)
+    {
+        std::cout << "  " << std::left << std::setw(48) << name << std::right << std::setw(10) << measurement.nanosecondsPerSymbol << " ns/symbol" << std::endl;
+        WriteHardwareCounters(std::cout, measurement.counters, measurement.calls, "symbol");
+    }
+
+#ifdef DEMANGLE_ALLOC_STATS
+
+    // Demangles each symbol once and returns the allocation counters of the demangler.
+    demangle_alloc_stats MeasureAllocations(const std::vector<const char*>& symbols)
+    {
+        demangle_alloc_stats stats{};
+
+        cplus_demangle_alloc_stats(&stats, 1);
+
+        for (const char* symbol : symbols)
+        {
+            std::free(cplus_demangle(symbol, DemangleOptions));
+        }
+
+        cplus_demangle_alloc_stats(&stats, 1);
+        return stats;
+    }
+
+    void AddAllocations(demangle_alloc_stats& total, const demangle_alloc_stats& stats)
+    {
+        total.xmalloc_calls += stats.xmalloc_calls;
+        total.xrealloc_calls += stats.xrealloc_calls;
+        total.free_calls += stats.free_calls;
+        total.allocated_bytes += stats.allocated_bytes;
+        total.string_need_reallocs += stats.string_need_reallocs;
+        total.prepend_bytes_moved += stats.prepend_bytes_moved;
+        total.typevec_grows += stats.typevec_grows;
+        total.ktypevec_grows += stats.ktypevec_grows;
+        total.btypevec_grows += stats.btypevec_grows;
+        total.typevec_max = std::max(total.typevec_max, stats.typevec_max);
+        total.ktypevec_max = std::max(total.ktypevec_max, stats.ktypevec_max);
+        total.btypevec_max = std::max(total.btypevec_max, stats.btypevec_max);
+    }
+
+    void PrintAllocations(const std::string& name, const demangle_alloc_stats& stats, size_t symbolCount)
+    {
+        const auto perSymbol = [symbolCount](unsigned long value) { return static_cast<double>(value) / static_cast<double>(symbolCount); };
+
+        std::cout << "  " << name << ":" << std::endl;
+        std::cout << "    xmalloc " << perSymbol(stats.xmalloc_calls)
+                  << ", xrealloc " << perSymbol(stats.xrealloc_calls)
+                  << ", free " << perSymbol(stats.free_calls)
+                  << ", bytes " << perSymbol(stats.allocated_bytes)
+                  << ", string_need reallocations " << perSymbol(stats.string_need_reallocs)
+                  << ", string_prependn bytes moved " << perSymbol(stats.prepend_bytes_moved) << std::endl;
+        std::cout << "    typevec grows " << perSymbol(stats.typevec_grows) << " (max " << stats.typevec_max << ")"
+                  << ", ktypevec grows " << perSymbol(stats.ktypevec_grows) << " (max " << stats.ktypevec_max << ")"
+                  << ", btypevec grows " << perSymbol(stats.btypevec_grows) << " (max " << stats.btypevec_max << ")" << std::endl;
+    }
+
+#endif
+}
+
+void RunAddressLookupBenchmark(const std::filesystem::path& binary, size_t lookupCount)
+{
+    const ElfSymbolReader reader(binary);
+    const AddressIndex index(reader);
+    const size_t symbolCount = index.GetSymbolCount();
+
+    if (symbolCount == 0)
+    {
+        throw std::runtime_error("The ELF file does not have any symbols with an address.");
+    }
+
+    // The addresses are spread over the address range that the symbols cover.
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<uint32_t> distribution(index.GetStartAddress(0), index.GetEndAddress(symbolCount - 1));
+    std::vector<uint32_t> addresses(lookupCount);
+
+    std::generate(addresses.begin(), addresses.end(), [&]() { return distribution(rng); });
+
+    std::vector<size_t> results(lookupCount);
+    size_t foundCount = 0;
+    HardwareCounters hardwareCounters;
+
+    std::cout << "Symbols: " << symbolCount << ", lookups: " << lookupCount << std::endl;
+
+    if (!hardwareCounters.IsAvailable())
+    {
+        std::cout << "Hardware counters are not available, " << hardwareCounters.GetUnavailableReason() << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    const LookupMeasurement find = MeasureLookups(hardwareCounters, [&]()
+    {
+        for (size_t i = 0; i < lookupCount; i++)
+        {
+            results[i] = index.Find(addresses[i]);
+        }
+    });
+    PrintRate("Find", lookupCount, find);
+
+    const LookupMeasurement unsortedBatch = MeasureLookups(hardwareCounters, [&]() { index.FindBatch(addresses.data(), lookupCount, results.data()); });
+    PrintRate("FindBatch (unsorted)", lookupCount, unsortedBatch);
+
+    foundCount = static_cast<size_t>(std::count_if(results.begin(), results.end(), [](size_t r) { return r != AddressIndex::NotFound; }));
+
+    std::sort(addresses.begin(), addresses.end());
+
+    const LookupMeasurement sortedBatch = MeasureLookups(hardwareCounters, [&]() { index.FindBatch(addresses.data(), lookupCount, results.data()); });
+    PrintRate("FindBatch (sorted)", lookupCount, sortedBatch);
+
+    // The first lookup of each symbol demangles its name, the following lookups reuse it.
+    for (size_t pass = 0; pass < 2; pass++)
+    {
+        LookupMeasurement findAndName = MeasureLookups(hardwareCounters, [&]()
+        {
+            for (size_t i = 0; i < lookupCount; i++)
+            {
+                if (results[i] != AddressIndex::NotFound)
+                {
+                    index.GetDemangledName(results[i]);
+                }
+            }
+        });
+
+        // The sorted batch lookup is included in the time and the counters.
+        findAndName.seconds += sortedBatch.seconds;
+
+        for (size_t i = 0; i < findAndName.counters.values.size(); i++)
+        {
+            findAndName.counters.values[i] += sortedBatch.counters.values[i];
+        }
+
+        PrintRate(pass == 0 ? "Find + demangle (cold)" : "Find + demangle (warm)", lookupCount, findAndName);
+    }
+
+    std::cout << foundCount << " of " << lookupCount << " addresses matched a symbol." << std::endl;
+}
+
+void RunDemangleBenchmark(size_t iterations)
+{
+    // Check the inputs first, a rejected input would measure the error path instead of the stage.
+    for (const StageBenchmark& benchmark : StageBenchmarks)
+    {
+        for (const char* input : benchmark.inputs)
+        {
+            if (!cplus_demangle_stage(benchmark.stage, input, DemangleOptions))
+            {
+                throw std::runtime_error(std::string("The ") + benchmark.name + " stage rejected the benchmark input: " + input);
+            }
+        }
+    }
+
+    for (const SymbolCategory& category : SymbolCategories)
+    {
+        for (const char* symbol : category.symbols)
+        {
+            char* demangled = cplus_demangle(symbol, DemangleOptions);
+
+            if (!demangled)
+            {
+                throw std::runtime_error(std::string("The demangler rejected the benchmark symbol: ") + symbol);
+            }
+
+            std::free(demangled);
+        }
+    }
+
+    HardwareCounters hardwareCounters;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Iterations: " << iterations << ", best of " << RepeatCount << " runs" << std::endl;
+
+    if (!hardwareCounters.IsAvailable())
+    {
+        std::cout << "Hardware counters are not available, " << hardwareCounters.GetUnavailableReason() << std::endl;
+    }
+    std::cout << "Stages:" << std::endl;
+
+    for (const StageBenchmark& benchmark : StageBenchmarks)
+    {
+        const SymbolMeasurement measurement = MeasureSymbols(hardwareCounters, benchmark.inputs.size(), iterations, [&]()
+        {
+            for (const char* input : benchmark.inputs)
+            {
+                cplus_demangle_stage(benchmark.stage, input, DemangleOptions);
+            }
+        });
+
+        PrintMeasurement(benchmark.name, measurement);
+    }
+
+    std::cout << "End to end:" << std::endl;
+
+    std::string result;
+
+    for (const SymbolCategory& category : SymbolCategories)
+    {
+        const SymbolMeasurement demangleMeasurement = MeasureSymbols(hardwareCounters, category.symbols.size(), iterations, [&]()
+        {
+            for (const char* symbol : category.symbols)
+            {
+                std::free(cplus_demangle(symbol, DemangleOptions));
+            }
+        });
+
+        PrintMeasurement(std::string("cplus_demangle, ") + category.name, demangleMeasurement);
+
+        // The difference to cplus_demangle is the cost of the parameter type substitutions.
+        const SymbolMeasurement fixedWidthMeasurement = MeasureSymbols(hardwareCounters, category.symbols.size(), iterations, [&]()
+        {
+            for (const char* symbol : category.symbols)
+            {
+                TryDemangle(symbol, DemangleFormat::FixedWidthTypes, result);
+            }
+        });
+
+        PrintMeasurement(std::string("TryDemangle fixed-width, ") + category.name, fixedWidthMeasurement);
+    }
+
+#ifdef DEMANGLE_ALLOC_STATS
+    std::cout << "Demangler allocations per symbol:" << std::endl;
+
+    demangle_alloc_stats total{};
+    size_t totalSymbolCount = 0;
+
+    for (const SymbolCategory& category : SymbolCategories)
+    {
+        const demangle_alloc_stats stats = MeasureAllocations(category.symbols);
+
+        PrintAllocations(category.name, stats, category.symbols.size());
+        AddAllocations(total, stats);
+        totalSymbolCount += category.symbols.size();
+    }
+
+    PrintAllocations("All categories", total, totalSymbolCount);
+#endif
+}
@@ -0,0 +1,31 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstddef>
+#include <filesystem>
+
+// Measures the AddressIndex lookup rate using random addresses within the symbols of the ELF file.
+void RunAddressLookupBenchmark(const std::filesystem::path& binary, size_t lookupCount);
+
+// Measures the time per symbol of each demangler parsing stage and of the complete demangler,
+// using curated symbols that are grouped by category.
+void RunDemangleBenchmark(size_t iterations);
@@ -0,0 +1,165 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "BuildManifest.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+static constexpr std::string_view ManifestSignature = "SC3KLinuxDemangle-manifest";
+
+BuildManifest::BuildManifest(const std::filesystem::path& path, std::string_view configuration)
+    : path(path), configuration(configuration)
+{
+    std::ifstream in(path, std::ifstream::in);
+
+    if (!in)
+    {
+        // The manifest does not exist, this is the first run.
+        return;
+    }
+
+    std::string line;
+
+    if (!std::getline(in, line) || line != std::string(ManifestSignature) + ' ' + this->configuration)
+    {
+        // The previous run used a different configuration, all of the inputs are treated as new.
+        return;
+    }
+
+    while (std::getline(in, line))
+    {
+        // Each line has the format: content_hash file_size last_write_time input_name
+        std::istringstream fields(line);
+        BuildManifestEntry entry{};
+        std::string inputName;
+
+        if (fields >> std::hex >> entry.contentHash >> std::dec >> entry.fileSize >> entry.lastWriteTime
+            && fields.get() == ' '
+            && std::getline(fields, inputName)
+            && !inputName.empty())
+        {
+            entries.insert_or_assign(std::move(inputName), entry);
+        }
+    }
+}
+
+const BuildManifestEntry* BuildManifest::Find(const std::string& inputName) const noexcept
+{
+    auto it = entries.find(inputName);
+
+    if (it != entries.end())
+    {
+        return &it->second;
+    }
+
+    it = previousEntries.find(inputName);
+
+    return it != previousEntries.end() ? &it->second : nullptr;
+}
+
+void BuildManifest::Set(const std::string& inputName, const BuildManifestEntry& entry)
+{
+    entries.insert_or_assign(inputName, entry);
+}
+
+void BuildManifest::Remove(const std::string& inputName)
+{
+    entries.erase(inputName);
+    previousEntries.erase(inputName);
+}
+
+void BuildManifest::Clear()
+{
+    previousEntries = std::move(entries);
+    entries.clear();
+}
+
+void BuildManifest::Save() const
+{
+    std::ostringstream out;
+
+    out << ManifestSignature << ' ' << configuration << '\n';
+
+    for (const auto& [inputName, entry] : entries)
+    {
+        out << std::hex << entry.contentHash << std::dec << ' ' << entry.fileSize << ' ' << entry.lastWriteTime << ' ' << inputName << '\n';
+    }
+
+    std::ofstream file(path, std::ofstream::out);
+    file << out.view();
+    file.close();
+
+    if (file.fail())
+    {
+        throw std::runtime_error("Failed to write the build manifest: " + path.string());
+    }
+}
+
+int64_t GetLastWriteTime(const std::filesystem::path& path)
+{
+    return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+uint64_t GetContentHash(std::string_view data) noexcept
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (const char c : data)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+bool WriteFileIfChanged(const std::filesystem::path& path, std::string_view contents)
+{
+    {
+        // The files are compared in text mode so that the line endings match the written output.
+        std::ifstream existing(path, std::ifstream::in);
+
+        if (existing)
+        {
+            std::ostringstream existingContents;
+            existingContents << existing.rdbuf();
+
+            if (existingContents.view() == contents)
+            {
+                return false;
+            }
+        }
+    }
+
+    std::ofstream out(path, std::ofstream::out);
+    out.write(contents.data(), contents.size());
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("Failed to write the output file: " + path.string());
+    }
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct BuildManifestEntry
+{
+    uint64_t contentHash;
+    uint64_t fileSize;
+    int64_t lastWriteTime;
+};
+
+// Records the state of the input files from the previous run of an incremental build.
+// The manifest is discarded when it was written with a different configuration, e.g. by
+// another version of the tool, so that every output is regenerated.
+class BuildManifest
+{
+public:
+    BuildManifest(const std::filesystem::path& path, std::string_view configuration);
+
+    // Returns the recorded state of the input, or nullptr if the input is new.
+    // The previous entries remain available after Clear, until the input is recorded again.
+    const BuildManifestEntry* Find(const std::string& inputName) const noexcept;
+
+    void Set(const std::string& inputName, const BuildManifestEntry& entry);
+    void Remove(const std::string& inputName);
+
+    // Starts recording a complete set of inputs, the inputs that are not recorded again are
+    // dropped when the manifest is saved.
+    void Clear();
+
+    void Save() const;
+
+private:
+    std::filesystem::path path;
+    std::string configuration;
+    std::unordered_map<std::string, BuildManifestEntry> previousEntries;
+    std::unordered_map<std::string, BuildManifestEntry> entries;
+};
+
+// Gets the time stamp that is stored in the manifest for the file.
+int64_t GetLastWriteTime(const std::filesystem::path& path);
+
+uint64_t GetContentHash(std::string_view data) noexcept;
+
+// Writes the file unless it already exists with the same contents, this keeps the modification
+// time of unchanged outputs stable.
+// Returns true if the file was written.
+bool WriteFileIfChanged(const std::filesystem::path& path, std::string_view contents);
@@ -0,0 +1,352 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "ClassDump.h"
+#include "DemangleStats.h"
+#include "DemangleTree.h"
+#include "DemangleUtil.h"
+#include "HeaderWriter.h"
+#include "LinePreprocessor.h"
+#include "Tracing.h"
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Reads the next line from the input, timed as part of the input phase.
+static bool ReadInputLine(std::istream& in, std::string& line)
+{
+    DEMANGLE_STATS_TIMER(ReadInput);
+
+    if (!std::getline(in, line))
+    {
+        return false;
+    }
+
+    DEMANGLE_STATS_COUNT(LinesRead);
+    return true;
+}
+
+void DemangleClassDump(
+    std::istream& in,
+    std::ostream& out,
+    std::vector<MalformedLine>& malformedLines,
+    DemangleCache* cache)
+{
+    size_t functionNameStart = 0;
+    // The class name is taken from the first line that is not blank or malformed.
+    bool haveClassHeader = false;
+    // The AddRef and Release methods that follow the QueryInterface method of a cIGZUnknown class.
+    int gzUnknownMethodsToSkip = 0;
+
+    // The line and mangled name buffers are reused for every line, once they have grown to
+    // fit the longest line no further allocations are made before the demangler runs.
+    std::string line;
+    std::string mangledName;
+    PreprocessedLine preprocessed;
+
+    // The loop stops when a read fails, the failed read at the end of the input is not a blank line.
+    for (size_t lineIndex = 0; ReadInputLine(in, line); lineIndex++)
+    {
+        const LinePreprocessStatus status = PreprocessLine(line, preprocessed);
+
+        if (status == LinePreprocessStatus::BlankLine)
+        {
+            // Skip any blank lines.
+            continue;
+        }
+        else if (status == LinePreprocessStatus::Malformed)
+        {
+            // Malformed lines are skipped and reported after the rest of the file has been processed.
+            malformedLines.push_back(MalformedLine{ lineIndex + 1, line, preprocessed.errorMessage });
+            continue;
+        }
+
+        // The demangler requires a null-terminated string.
+        mangledName.assign(preprocessed.mangledName);
+
+        std::string result;
+        size_t index = std::string::npos;
+
+        const bool isClassHeaderLine = !haveClassHeader;
+
+        if (isClassHeaderLine)
+        {
+            // The first name is demangled once as a tree, the class name is the scope of the tree.
+            std::pmr::monotonic_buffer_resource arena;
+            const DemangleTree* const tree = BuildDemangleTree(mangledName.c_str(), arena);
+
+            if (tree)
+            {
+                result.assign(tree->text);
+
+                {
+                    DEMANGLE_STATS_TIMER(ParameterSubstitution);
+                    ConvertToFixedWidthTypes(result);
+                }
+
+                index = FindDemangleTreeScopeEnd(*tree, result);
+            }
+            else
+            {
+                result = mangledName;
+            }
+
+            haveClassHeader = true;
+        }
+        else if (cache)
+        {
+            if (!cache->TryDemangle(mangledName, result))
+            {
+                result = mangledName;
+            }
+        }
+        else
+        {
+            result = GetDemangledLine(mangledName.c_str());
+        }
+
+        std::string_view resultAsStringView(result);
+
+        if (isClassHeaderLine)
+        {
+            // We strip the class name from the start of the function string
+            // when writing it to the output.
+            if (index != std::string::npos)
+            {
+                functionNameStart = index + 2;
+                const bool isGZUnknownClass = resultAsStringView.substr(functionNameStart).compare(QueryInterfaceMethod) == 0;
+
+                // Write the class name at the top of the file.
+                DEMANGLE_STATS_TIMER(WriteOutput);
+                WriteHeaderStart(out, resultAsStringView.substr(0, index), isGZUnknownClass);
+
+                if (isGZUnknownClass)
+                {
+                    // We don't write the QueryInterface method to the file.
+                    gzUnknownMethodsToSkip = 2;
+                    continue;
+                }
+            }
+        }
+        else if (gzUnknownMethodsToSkip > 0)
+        {
+            // We don't write the AddRef or Release methods to the file.
+            gzUnknownMethodsToSkip--;
+            continue;
+        }
+
+        DEMANGLE_STATS_TIMER(WriteOutput);
+        WriteHeaderMethod(out, resultAsStringView.substr(functionNameStart));
+    }
+
+    DEMANGLE_STATS_TIMER(WriteOutput);
+    WriteHeaderEnd(out);
+}
+
+static void DemangleInputFile(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    std::vector<MalformedLine>& malformedLines)
+{
+    TRACE_SPAN("convert class dump");
+    std::ifstream in(input, std::ifstream::in);
+
+    // The input is checked before the output is created, in-place mode would otherwise
+    // replace a missing or unreadable input with an empty header.
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Failed to open the file: " + input.string());
+    }
+
+    std::ofstream out(output, std::ofstream::out);
+
+    DemangleClassDump(in, out, malformedLines);
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("Failed to write the output file.");
+    }
+}
+
+// https://stackoverflow.com/a/24586587
+static std::string GetRandomFileName(std::string::size_type length)
+{
+    static auto& chrs = "0123456789"
+        "abcdefghijklmnopqrstuvwxyz"
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    thread_local static std::mt19937 rg{ std::random_device{}() };
+    thread_local static std::uniform_int_distribution<std::string::size_type> pick(0, sizeof(chrs) - 2);
+
+    std::string s;
+
+    s.reserve(length);
+
+    while (length--)
+    {
+        s += chrs[pick(rg)];
+    }
+
+    return s;
+}
+
+static std::filesystem::path GetTemporaryFilePath(const std::filesystem::path& targetFile)
+{
+    // The temporary file is placed in the same directory as the file it will replace, this
+    // allows it to be renamed over the target without copying the data to another volume.
+    std::filesystem::path path = targetFile.parent_path();
+    path /= "." + GetRandomFileName(8);
+    path += L".tmp";
+
+    return path;
+}
+
+// Writes the file data that the operating system has cached to the disk, so that a crash after the
+// file has been renamed over its target cannot leave an empty or partly written target.
+static void FlushFileToDisk(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open the file: " + path.string());
+    }
+
+    const bool flushed = FlushFileBuffers(file) != FALSE;
+    CloseHandle(file);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+
+    if (file == -1)
+    {
+        throw std::runtime_error("Failed to open the file: " + path.string());
+    }
+
+    const bool flushed = fsync(file) == 0;
+    close(file);
+#endif
+
+    if (!flushed)
+    {
+        throw std::runtime_error("Failed to write the file to the disk: " + path.string());
+    }
+}
+
+#ifndef _WIN32
+// Writes the directory entries to the disk, this makes a rename in the directory durable.
+// Errors are ignored, some file systems do not support flushing a directory.
+static void FlushDirectoryToDisk(const std::filesystem::path& directory)
+{
+    const int file = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+
+    if (file != -1)
+    {
+        fsync(file);
+        close(file);
+    }
+}
+#endif
+
+void WriteMalformedLineReport(const std::filesystem::path& output, const std::vector<MalformedLine>& malformedLines)
+{
+    std::filesystem::path reportPath = output;
+    reportPath += L".errors.txt";
+
+    if (malformedLines.empty())
+    {
+        // Remove the report from a previous run, if any.
+        std::error_code ec;
+        std::filesystem::remove(reportPath, ec);
+        return;
+    }
+
+    std::ofstream report(reportPath, std::ofstream::out);
+
+    for (const MalformedLine& item : malformedLines)
+    {
+        report << "Line " << item.lineNumber << ": " << item.errorMessage << '\n';
+        report << "    " << item.text << '\n';
+    }
+
+    std::cout << malformedLines.size() << " malformed line(s) were skipped, see " << reportPath.string() << std::endl;
+}
+
+void DemangleInputFile(const std::filesystem::path& input, const std::filesystem::path& output)
+{
+    std::vector<MalformedLine> malformedLines;
+
+    DemangleInputFile(input, output, malformedLines);
+    WriteMalformedLineReport(output, malformedLines);
+}
+
+void DemangleInputFileInPlace(const std::filesystem::path& input)
+{
+    const std::filesystem::path temporaryFile = GetTemporaryFilePath(input);
+    std::vector<MalformedLine> malformedLines;
+
+    try
+    {
+        // The output is closed and checked for write errors before it is flushed to the disk.
+        DemangleInputFile(input, temporaryFile, malformedLines);
+        FlushFileToDisk(temporaryFile);
+
+        // The output keeps the permissions of the file it replaces.
+        std::filesystem::permissions(temporaryFile, std::filesystem::status(input).permissions());
+
+        // The rename replaces the input file atomically, so the input is either left untouched
+        // or completely replaced by the output if the process is interrupted.
+        std::filesystem::rename(temporaryFile, input);
+    }
+    catch (...)
+    {
+        std::error_code ec;
+        std::filesystem::remove(temporaryFile, ec);
+
+        throw;
+    }
+
+#ifndef _WIN32
+    FlushDirectoryToDisk(input.parent_path());
+#endif
+
+    WriteMalformedLineReport(input, malformedLines);
+}
@@ -0,0 +1,54 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "DemangleCache.h"
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A class dump is a text file with the mangled names of one class, one name per line.
+// It is converted to a header that declares the class methods.
+
+struct MalformedLine
+{
+    size_t lineNumber;
+    std::string text;
+    const char* errorMessage;
+};
+
+// Converts a class dump to a header, malformed lines are skipped and added to the list.
+// The names are demangled through the cache when one is provided.
+void DemangleClassDump(
+    std::istream& in,
+    std::ostream& out,
+    std::vector<MalformedLine>& malformedLines,
+    DemangleCache* cache = nullptr);
+
+// Writes the malformed lines to <output>.errors.txt, or removes an existing report when there are none.
+void WriteMalformedLineReport(const std::filesystem::path& output, const std::vector<MalformedLine>& malformedLines);
+
+void DemangleInputFile(const std::filesystem::path& input, const std::filesystem::path& output);
+
+// Replaces the class dump with the header, the file is replaced atomically.
+void DemangleInputFileInPlace(const std::filesystem::path& input);
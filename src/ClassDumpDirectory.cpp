@@ -0,0 +1,353 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "ClassDumpDirectory.h"
+#include "BuildManifest.h"
+#include "ClassDump.h"
+#include "DemangleCache.h"
+#include "DemangleUtil.h"
+#include "DirectoryWatcher.h"
+#include "HeaderWriter.h"
+#include "ThreadPool.h"
+#include "Tracing.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+    struct ClassDumpUpdate
+    {
+        std::filesystem::path input;
+        std::filesystem::path output;
+        std::string inputName;
+        BuildManifestEntry entry;
+        std::vector<MalformedLine> malformedLines;
+        // The reason the header could not be generated, empty if the update succeeded.
+        std::string errorMessage;
+        // Set when the input is known to have changed, the size and time stamp check is skipped.
+        bool changed;
+        bool regenerated;
+        bool written;
+    };
+}
+
+static std::string GetClassDumpConfiguration()
+{
+    return "format=FixedWidthTypes substitutions=" + std::to_string(ParameterSubstitutionsVersion)
+        + " header=" + std::to_string(HeaderFormatVersion);
+}
+
+static bool IsClassDumpFile(const std::filesystem::path& path)
+{
+    return path.extension() == ".txt" && !path.filename().string().ends_with(".errors.txt");
+}
+
+static std::filesystem::path GetHeaderPath(const std::filesystem::path& input, const std::filesystem::path& outputDirectory)
+{
+    return outputDirectory / input.filename().replace_extension(".h");
+}
+
+static ClassDumpUpdate& AddClassDumpUpdate(
+    std::vector<ClassDumpUpdate>& items,
+    const std::filesystem::path& input,
+    const std::filesystem::path& outputDirectory)
+{
+    ClassDumpUpdate& item = items.emplace_back();
+    item.input = input;
+    item.output = GetHeaderPath(input, outputDirectory);
+    item.inputName = input.filename().string();
+
+    return item;
+}
+
+static void UpdateClassDump(ClassDumpUpdate& item, const BuildManifest& manifest, DemangleCache* cache)
+{
+    const BuildManifestEntry* const previous = manifest.Find(item.inputName);
+    const bool outputExists = std::filesystem::exists(item.output);
+
+    item.entry.fileSize = std::filesystem::file_size(item.input);
+    item.entry.lastWriteTime = GetLastWriteTime(item.input);
+
+    if (previous && outputExists && !item.changed
+        && previous->fileSize == item.entry.fileSize
+        && previous->lastWriteTime == item.entry.lastWriteTime)
+    {
+        // The input has not been modified since the previous run, skip it without reading the file.
+        item.entry.contentHash = previous->contentHash;
+        return;
+    }
+
+    std::string contents;
+    {
+        TRACE_SPAN("read");
+        std::ifstream in(item.input, std::ifstream::in);
+
+        // The input can be removed after it was listed, e.g. by an editor that replaces the file.
+        if (!in.is_open())
+        {
+            throw std::runtime_error("Failed to open the file: " + item.input.string());
+        }
+
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        contents = std::move(buffer).str();
+    }
+
+    item.entry.contentHash = GetContentHash(contents);
+
+    if (previous && outputExists && previous->contentHash == item.entry.contentHash)
+    {
+        // The file was touched but its contents are unchanged.
+        return;
+    }
+
+    std::istringstream in(std::move(contents));
+    std::ostringstream out;
+
+    {
+        TRACE_SPAN("demangle");
+        DemangleClassDump(in, out, item.malformedLines, cache);
+    }
+
+    TRACE_SPAN("write");
+    item.regenerated = true;
+    item.written = WriteFileIfChanged(item.output, out.view());
+}
+
+// Regenerates the headers of the class dumps that changed and records them in the manifest.
+// A class dump that cannot be converted is reported and left out of the manifest, so that it is
+// checked again by the next update. Returns the number of class dumps that could not be converted.
+static size_t UpdateClassDumps(
+    std::vector<ClassDumpUpdate>& items,
+    BuildManifest& manifest,
+    ThreadPool& threadPool,
+    DemangleCache* cache)
+{
+    for (ClassDumpUpdate& item : items)
+    {
+        threadPool.Submit([&item, &manifest, cache]()
+        {
+            try
+            {
+                UpdateClassDump(item, manifest, cache);
+            }
+            catch (const std::exception& e)
+            {
+                item.errorMessage = e.what();
+            }
+        });
+    }
+
+    threadPool.Wait();
+
+    size_t regeneratedCount = 0;
+    size_t writtenCount = 0;
+    size_t failedCount = 0;
+
+    for (const ClassDumpUpdate& item : items)
+    {
+        if (!item.errorMessage.empty())
+        {
+            std::cerr << item.errorMessage << std::endl;
+            manifest.Remove(item.inputName);
+            failedCount++;
+            continue;
+        }
+
+        if (item.regenerated)
+        {
+            regeneratedCount++;
+            WriteMalformedLineReport(item.output, item.malformedLines);
+        }
+
+        if (item.written)
+        {
+            writtenCount++;
+        }
+
+        manifest.Set(item.inputName, item.entry);
+    }
+
+    manifest.Save();
+
+    std::cout << "Checked " << items.size() << " class dump(s), regenerated " << regeneratedCount
+              << ", wrote " << writtenCount << " changed header(s)";
+
+    if (failedCount != 0)
+    {
+        std::cout << ", " << failedCount << " class dump(s) failed";
+    }
+
+    std::cout << '.' << std::endl;
+
+    return failedCount;
+}
+
+// Checks every class dump in the input directory, the manifest entries of removed inputs are dropped.
+static size_t UpdateClassDumpDirectory(
+    const std::filesystem::path& inputDirectory,
+    const std::filesystem::path& outputDirectory,
+    BuildManifest& manifest,
+    ThreadPool& threadPool,
+    DemangleCache* cache)
+{
+    std::vector<ClassDumpUpdate> items;
+
+    for (const auto& dirEntry : std::filesystem::directory_iterator(inputDirectory))
+    {
+        if (dirEntry.is_regular_file() && IsClassDumpFile(dirEntry.path()))
+        {
+            AddClassDumpUpdate(items, dirEntry.path(), outputDirectory);
+        }
+    }
+
+    manifest.Clear();
+    return UpdateClassDumps(items, manifest, threadPool, cache);
+}
+
+// Checked before the output directory is created, which can be the input directory in watch mode.
+static void CheckInputDirectory(const std::filesystem::path& inputDirectory)
+{
+    if (!std::filesystem::is_directory(inputDirectory))
+    {
+        throw std::runtime_error("The input directory does not exist: " + inputDirectory.string());
+    }
+}
+
+static std::filesystem::path GetManifestPath(const std::filesystem::path& outputDirectory)
+{
+    return outputDirectory / ".SC3KLinuxDemangle.manifest";
+}
+
+void DemangleInputDirectory(const std::filesystem::path& inputDirectory, const std::filesystem::path& outputDirectory)
+{
+    CheckInputDirectory(inputDirectory);
+    std::filesystem::create_directories(outputDirectory);
+
+    BuildManifest manifest(GetManifestPath(outputDirectory), GetClassDumpConfiguration());
+    ThreadPool threadPool;
+
+    if (UpdateClassDumpDirectory(inputDirectory, outputDirectory, manifest, threadPool, nullptr) != 0)
+    {
+        throw std::runtime_error("Some of the class dumps could not be converted.");
+    }
+}
+
+// Regenerates the headers of the changed class dumps, the header of a removed class dump is deleted.
+static void UpdateChangedClassDumps(
+    const DirectoryChanges& changes,
+    const std::filesystem::path& inputDirectory,
+    const std::filesystem::path& outputDirectory,
+    BuildManifest& manifest,
+    ThreadPool& threadPool,
+    DemangleCache& cache)
+{
+    if (changes.rescanRequired)
+    {
+        UpdateClassDumpDirectory(inputDirectory, outputDirectory, manifest, threadPool, &cache);
+        return;
+    }
+
+    std::vector<ClassDumpUpdate> items;
+    bool removedInput = false;
+
+    for (const DirectoryChange& change : changes.files)
+    {
+        if (!IsClassDumpFile(change.path))
+        {
+            continue;
+        }
+
+        std::error_code ec;
+
+        if (change.type == DirectoryChangeType::Modified && std::filesystem::is_regular_file(change.path, ec))
+        {
+            AddClassDumpUpdate(items, change.path, outputDirectory).changed = true;
+        }
+        else
+        {
+            const std::filesystem::path header = GetHeaderPath(change.path, outputDirectory);
+
+            manifest.Remove(change.path.filename().string());
+
+            if (std::filesystem::remove(header, ec))
+            {
+                std::cout << "Removed " << header.string() << std::endl;
+            }
+
+            // An empty list removes the malformed line report, if any.
+            WriteMalformedLineReport(header, std::vector<MalformedLine>());
+            removedInput = true;
+        }
+    }
+
+    if (!items.empty())
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        UpdateClassDumps(items, manifest, threadPool, &cache);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "Updated in " << elapsed.count() << " ms." << std::endl;
+    }
+    else if (removedInput)
+    {
+        manifest.Save();
+    }
+}
+
+void WatchInputDirectory(const std::filesystem::path& inputDirectory, const std::filesystem::path& outputDirectory)
+{
+    CheckInputDirectory(inputDirectory);
+    std::filesystem::create_directories(outputDirectory);
+
+    // The watcher is started before the initial update so that no changes are missed.
+    DirectoryWatcher watcher(inputDirectory);
+    BuildManifest manifest(GetManifestPath(outputDirectory), GetClassDumpConfiguration());
+    ThreadPool threadPool;
+    // The cache keeps the demangled names of the whole session, most edits only add or change a few names.
+    DemangleCache cache(DemangleFormat::FixedWidthTypes);
+
+    UpdateClassDumpDirectory(inputDirectory, outputDirectory, manifest, threadPool, &cache);
+    std::cout << "Watching " << inputDirectory.string() << " for changes, press Ctrl+C to stop." << std::endl;
+
+    while (true)
+    {
+        const DirectoryChanges changes = watcher.WaitForChanges();
+
+        // An error only stops the current update, e.g. when a class dump is removed while it is being read.
+        try
+        {
+            UpdateChangedClassDumps(changes, inputDirectory, outputDirectory, manifest, threadPool, cache);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <filesystem>
+
+// Converts every class dump (.txt file) in the input directory to a header in the output directory.
+// A manifest in the output directory records the inputs, so only the class dumps that changed since
+// the previous run are converted. Headers are only written when their contents change.
+void DemangleInputDirectory(const std::filesystem::path& inputDirectory, const std::filesystem::path& outputDirectory);
+
+// Updates the output directory, then converts the class dumps as they are created or modified.
+// This function does not return unless an error occurs.
+void WatchInputDirectory(const std::filesystem::path& inputDirectory, const std::filesystem::path& outputDirectory);
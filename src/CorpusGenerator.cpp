@@ -0,0 +1,623 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "CorpusGenerator.h"
+#include "DemangleUtil.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+extern "C"
+{
+#include "demangle.h"
+#include "ReferenceDemangler.h"
+}
+
+static constexpr size_t CorpusChunkSize = 65536;
+static constexpr int MaxGenerateAttempts = 100;
+
+namespace
+{
+    constexpr std::array<const char*, 16> BuiltinTypes{ "c", "Sc", "Uc", "s", "Us", "i", "Ui", "l", "Ul", "x", "Ux", "f", "d", "r", "b", "w" };
+    constexpr std::array<const char*, 22> Operators{ "as", "eq", "ne", "lt", "gt", "le", "ge", "pl", "mi", "ml", "dv", "md", "ls", "rs", "vc", "cl", "aad", "apl", "ami", "nt", "pp", "mm" };
+    constexpr std::array<const char*, 6> ReturnTypes{ "void", "bool", "int32_t", "uint32_t", "float", "cRZString*" };
+    constexpr std::array<const char*, 6> ClassPrefixes{ "cRZ", "cSC3", "cGZ", "cS3D", "cIGZ", "c" };
+    constexpr std::array<const char*, 20> Verbs{ "Get", "Set", "Init", "Shutdown", "Update", "Draw", "Load", "Save", "Find", "Add", "Remove", "Create", "Destroy", "Is", "Has", "Process", "Notify", "Reset", "Apply", "Query" };
+    constexpr std::array<const char*, 31> Syllables
+    {
+        "Sim", "City", "Zone", "Road", "Tile", "Build", "Power", "Water", "Map", "View", "Cam", "Sound", "Text", "Font", "Menu", "Data",
+        "Res", "Net", "Game", "Occ", "Lot", "Prop", "Flora", "Budget", "Pop", "Traffic", "Anim", "Model", "Image", "File", "Path"
+    };
+
+    struct NamePools
+    {
+        std::vector<std::string> classNames;
+        std::vector<std::string> methodNames;
+    };
+
+    NamePools CreateNamePools(uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        NamePools pools;
+
+        const auto pick = [&](const auto& items) { return items[rng() % items.size()]; };
+
+        for (size_t i = 0; i < 4096; i++)
+        {
+            std::string name = pick(ClassPrefixes);
+            const size_t syllableCount = 1 + (rng() % 3);
+
+            for (size_t j = 0; j < syllableCount; j++)
+            {
+                name += pick(Syllables);
+            }
+
+            pools.classNames.push_back(std::move(name));
+        }
+
+        for (size_t i = 0; i < 1024; i++)
+        {
+            pools.methodNames.push_back(std::string(pick(Verbs)) + pick(Syllables) + ((rng() % 2) ? pick(Syllables) : ""));
+        }
+
+        return pools;
+    }
+
+    class SymbolGenerator
+    {
+    public:
+        SymbolGenerator(const CorpusOptions& options, const NamePools& pools, uint64_t chunkIndex)
+            : options(options), pools(pools)
+        {
+            std::seed_seq seed{ static_cast<uint32_t>(options.seed), static_cast<uint32_t>(options.seed >> 32), static_cast<uint32_t>(chunkIndex) };
+            rng.seed(seed);
+        }
+
+        // Generates an input line, the mangled name that the line contains and the reference demangler output
+        // for the name. Returns false if the reference demangler rejects the name.
+        bool Generate(std::string& line, std::string& mangledName, std::string& demangledName)
+        {
+            mangledName.clear();
+            functionPointerUsed = false;
+
+            const double kind = unitDistribution(rng);
+            double threshold = options.constructorProbability;
+            // Constructors are never virtual, so they do not have thunks or virtual prototype lines.
+            bool isVirtualMethod = true;
+
+            if (kind < threshold)
+            {
+                isVirtualMethod = false;
+                mangledName += "__";
+                AppendClassName(mangledName, 0);
+                AppendParameters(mangledName, 1);
+            }
+            else if (kind < (threshold += options.destructorProbability))
+            {
+                mangledName += "_$_";
+                AppendClassName(mangledName, 0);
+            }
+            else if (kind < (threshold += options.operatorProbability))
+            {
+                mangledName += "__";
+                mangledName += Pick(Operators);
+                mangledName += "__";
+                AppendMethodClass(mangledName);
+                AppendParameters(mangledName, 1);
+            }
+            else if (kind < (threshold += options.freeFunctionProbability))
+            {
+                isVirtualMethod = false;
+                mangledName += Pick(pools.methodNames);
+                mangledName += "__F";
+                AppendParameters(mangledName, 0);
+            }
+            else
+            {
+                mangledName += Pick(pools.methodNames);
+                mangledName += "__";
+                AppendMethodClass(mangledName);
+                AppendParameters(mangledName, 1);
+            }
+
+            char* demangled = reference_cplus_demangle(mangledName.c_str(), DMGL_PARAMS | DMGL_ANSI);
+
+            if (!demangled)
+            {
+                return false;
+            }
+
+            demangledName.assign(demangled);
+            std::free(demangled);
+
+            line.clear();
+
+            const bool isVirtualPrototype = isVirtualMethod && Chance(options.virtualPrototypeProbability);
+
+            if (isVirtualPrototype)
+            {
+                line += "virtual ";
+                line += Pick(ReturnTypes);
+                line += ' ';
+            }
+
+            if (isVirtualMethod && Chance(options.thunkProbability))
+            {
+                line += "__thunk_";
+                line += std::to_string(4 * (1 + Uniform(8)));
+                line += '_';
+            }
+
+            line += mangledName;
+
+            if (isVirtualPrototype)
+            {
+                // The class dumps list the parameters of the prototype with the fixed-width types.
+                std::string signature = demangledName;
+
+                ConvertToFixedWidthTypes(signature);
+
+                line += '(';
+                line += GetParameterList(signature);
+                line += ')';
+            }
+
+            return true;
+        }
+
+    private:
+        bool Chance(double probability)
+        {
+            return unitDistribution(rng) < probability;
+        }
+
+        size_t Uniform(size_t count)
+        {
+            return static_cast<size_t>(rng() % count);
+        }
+
+        template <typename T> const typename T::value_type& Pick(const T& items)
+        {
+            return items[Uniform(items.size())];
+        }
+
+        // Returns the text between the parentheses of the parameter list, the demangler writes (void) for a method without parameters.
+        static std::string_view GetParameterList(std::string_view signature)
+        {
+            const size_t end = signature.rfind(')');
+            size_t depth = 0;
+
+            // The parameters can contain function pointer types, which have their own parentheses.
+            for (size_t i = end; i-- > 0;)
+            {
+                if (signature[i] == ')')
+                {
+                    depth++;
+                }
+                else if (signature[i] == '(')
+                {
+                    if (depth == 0)
+                    {
+                        const std::string_view parameters = signature.substr(i + 1, end - i - 1);
+
+                        return parameters == "void" ? std::string_view() : parameters;
+                    }
+
+                    depth--;
+                }
+            }
+
+            return std::string_view();
+        }
+
+        static void AppendIdentifier(std::string& out, std::string_view identifier)
+        {
+            out += std::to_string(identifier.size());
+            out += identifier;
+        }
+
+        void AppendMethodClass(std::string& out)
+        {
+            if (Chance(options.constMethodProbability))
+            {
+                out += 'C';
+            }
+
+            AppendClassName(out, 0);
+        }
+
+        void AppendClassName(std::string& out, int depth)
+        {
+            if (depth == 0 && options.maxQualifiers >= 2 && Chance(options.qualifiedClassProbability))
+            {
+                const size_t qualifiers = 2 + Uniform(options.maxQualifiers - 1);
+
+                out += 'Q';
+                out += static_cast<char>('0' + qualifiers);
+
+                for (size_t i = 0; i < qualifiers; i++)
+                {
+                    AppendIdentifier(out, Pick(pools.classNames));
+                }
+            }
+            else if (depth < 2 && Chance(options.templateClassProbability))
+            {
+                AppendTemplateClass(out, depth);
+            }
+            else
+            {
+                AppendIdentifier(out, Pick(pools.classNames));
+            }
+        }
+
+        void AppendTemplateClass(std::string& out, int depth)
+        {
+            const size_t parameterCount = 1 + Uniform(3);
+
+            out += 't';
+            AppendIdentifier(out, Pick(pools.classNames));
+            out += std::to_string(parameterCount);
+
+            for (size_t i = 0; i < parameterCount; i++)
+            {
+                if (Chance(options.templateValueParameterProbability))
+                {
+                    // An int value parameter, negative values use an 'm' prefix.
+                    const int value = static_cast<int>(Uniform(200)) - 50;
+
+                    out += 'i';
+
+                    if (value < 0)
+                    {
+                        out += 'm';
+                    }
+                    out += std::to_string(std::abs(value));
+                }
+                else
+                {
+                    out += 'Z';
+                    AppendType(out, depth + 1);
+                }
+            }
+        }
+
+        void AppendType(std::string& out, int depth)
+        {
+            if (depth < 2 && Chance(options.functionPointerProbability))
+            {
+                // The demangler remembers the types of a function pointer's parameters, the
+                // back-references that follow it are not generated so their indices stay valid.
+                functionPointerUsed = true;
+
+                out += "PF";
+                AppendParameterList(out, depth + 1, Uniform(4));
+                out += '_';
+                out += Chance(0.5) ? "v" : Pick(BuiltinTypes);
+                return;
+            }
+
+            if (Chance(options.pointerProbability))
+            {
+                out += Chance(0.1) ? "PP" : "P";
+
+                if (Chance(options.constProbability))
+                {
+                    out += 'C';
+                }
+            }
+            else if (Chance(options.referenceProbability))
+            {
+                out += 'R';
+
+                if (Chance(options.constProbability))
+                {
+                    out += 'C';
+                }
+            }
+
+            if (Chance(options.classParameterProbability))
+            {
+                AppendClassName(out, depth + 1);
+            }
+            else
+            {
+                out += Pick(BuiltinTypes);
+            }
+        }
+
+        void AppendParameterList(std::string& out, int depth, size_t count)
+        {
+            if (count == 0)
+            {
+                out += 'v';
+                return;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                AppendType(out, depth);
+            }
+        }
+
+        // The type count is the number of types that the demangler has remembered before the
+        // parameters, a method remembers its class.
+        void AppendParameters(std::string& out, size_t typeCount)
+        {
+            const size_t count = Uniform(options.maxParameters + 1);
+
+            if (count == 0)
+            {
+                out += 'v';
+                return;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const size_t maxIndex = std::min<size_t>(typeCount, 10);
+
+                if (!functionPointerUsed && typeCount > 0 && Chance(options.backReferenceProbability))
+                {
+                    const size_t remaining = count - i;
+
+                    if (remaining >= 2 && Chance(0.3))
+                    {
+                        // N<count><index> repeats a type, every repetition is remembered again.
+                        const size_t repeats = 2 + Uniform(std::min<size_t>(remaining, 9) - 1);
+
+                        out += 'N';
+                        out += static_cast<char>('0' + repeats);
+                        out += static_cast<char>('0' + Uniform(maxIndex));
+                        typeCount += repeats;
+                        i += repeats - 1;
+                    }
+                    else
+                    {
+                        out += 'T';
+                        out += static_cast<char>('0' + Uniform(maxIndex));
+                        typeCount++;
+                    }
+                }
+                else
+                {
+                    AppendType(out, 0);
+                    typeCount++;
+                }
+            }
+        }
+
+        const CorpusOptions& options;
+        const NamePools& pools;
+        std::mt19937_64 rng;
+        std::uniform_real_distribution<double> unitDistribution;
+        bool functionPointerUsed = false;
+    };
+
+    struct CorpusChunk
+    {
+        std::string lines;
+        std::string expected;
+        size_t replacedCount = 0;
+    };
+
+    void GenerateChunk(const CorpusOptions& options, const NamePools& pools, uint64_t chunkIndex, size_t symbolCount, CorpusChunk& chunk)
+    {
+        SymbolGenerator generator(options, pools, chunkIndex);
+        std::string line;
+        std::string mangledName;
+        std::string demangledName;
+
+        for (size_t i = 0; i < symbolCount; i++)
+        {
+            for (int attempt = 0;; attempt++)
+            {
+                if (attempt == MaxGenerateAttempts)
+                {
+                    throw std::runtime_error("The corpus options do not produce names that the demangler accepts.");
+                }
+
+                if (generator.Generate(line, mangledName, demangledName))
+                {
+                    chunk.lines += line;
+                    chunk.lines += '\n';
+                    chunk.expected += demangledName;
+                    chunk.expected += '\n';
+                    break;
+                }
+
+                chunk.replacedCount++;
+            }
+        }
+    }
+
+    bool ParseValue(std::string_view text, double& value)
+    {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+        return ec == std::errc() && ptr == text.data() + text.size() && value >= 0.0 && value <= 1.0;
+    }
+
+    bool ParseValue(std::string_view text, size_t& value)
+    {
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+        return ec == std::errc() && ptr == text.data() + text.size();
+    }
+}
+
+void SetCorpusOption(CorpusOptions& options, std::string_view setting)
+{
+    const size_t separator = setting.find('=');
+
+    if (separator == std::string_view::npos)
+    {
+        throw std::runtime_error("The corpus option must use the format name=value: " + std::string(setting));
+    }
+
+    const std::string_view name = setting.substr(0, separator);
+    const std::string_view value = setting.substr(separator + 1);
+
+    static const std::array<std::pair<std::string_view, double CorpusOptions::*>, 16> Probabilities
+    {{
+        { "thunk", &CorpusOptions::thunkProbability },
+        { "virtualPrototype", &CorpusOptions::virtualPrototypeProbability },
+        { "constructor", &CorpusOptions::constructorProbability },
+        { "destructor", &CorpusOptions::destructorProbability },
+        { "operator", &CorpusOptions::operatorProbability },
+        { "freeFunction", &CorpusOptions::freeFunctionProbability },
+        { "constMethod", &CorpusOptions::constMethodProbability },
+        { "qualifiedClass", &CorpusOptions::qualifiedClassProbability },
+        { "templateClass", &CorpusOptions::templateClassProbability },
+        { "templateValueParameter", &CorpusOptions::templateValueParameterProbability },
+        { "classParameter", &CorpusOptions::classParameterProbability },
+        { "pointer", &CorpusOptions::pointerProbability },
+        { "reference", &CorpusOptions::referenceProbability },
+        { "const", &CorpusOptions::constProbability },
+        { "functionPointer", &CorpusOptions::functionPointerProbability },
+        { "backReference", &CorpusOptions::backReferenceProbability },
+    }};
+
+    for (const auto& [optionName, member] : Probabilities)
+    {
+        if (name == optionName)
+        {
+            if (!ParseValue(value, options.*member))
+            {
+                throw std::runtime_error("The corpus option value must be a number between 0 and 1: " + std::string(setting));
+            }
+            return;
+        }
+    }
+
+    if (name == "maxParameters" || name == "maxQualifiers")
+    {
+        size_t& member = name == "maxParameters" ? options.maxParameters : options.maxQualifiers;
+
+        // The qualifier count is written as a single digit.
+        if (!ParseValue(value, member) || member > 9)
+        {
+            throw std::runtime_error("The corpus option value must be a number between 0 and 9: " + std::string(setting));
+        }
+        return;
+    }
+
+    throw std::runtime_error("Unknown corpus option: " + std::string(setting));
+}
+
+size_t GenerateCorpus(const CorpusOptions& options, const std::filesystem::path& outputPrefix, ThreadPool& threadPool)
+{
+    std::filesystem::path linesPath = outputPrefix;
+    linesPath += ".txt";
+    std::filesystem::path expectedPath = outputPrefix;
+    expectedPath += ".expected.txt";
+
+    std::ofstream lines(linesPath, std::ofstream::out | std::ofstream::binary);
+    std::ofstream expected(expectedPath, std::ofstream::out | std::ofstream::binary);
+
+    const NamePools pools = CreateNamePools(options.seed);
+    const size_t chunkCount = (options.symbolCount + CorpusChunkSize - 1) / CorpusChunkSize;
+    // Limit the number of chunks that are in memory at the same time.
+    const size_t maxPendingChunks = threadPool.GetThreadCount() * 2;
+    std::deque<std::pair<std::shared_ptr<CorpusChunk>, std::future<void>>> pendingChunks;
+    size_t replacedCount = 0;
+
+    const auto writeChunk = [&]()
+    {
+        auto& [chunk, done] = pendingChunks.front();
+
+        // Rethrows any exception from the worker thread.
+        done.get();
+
+        lines.write(chunk->lines.data(), static_cast<std::streamsize>(chunk->lines.size()));
+        expected.write(chunk->expected.data(), static_cast<std::streamsize>(chunk->expected.size()));
+        replacedCount += chunk->replacedCount;
+
+        pendingChunks.pop_front();
+    };
+
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        const size_t symbolCount = std::min(CorpusChunkSize, options.symbolCount - (chunkIndex * CorpusChunkSize));
+        auto chunk = std::make_shared<CorpusChunk>();
+        auto task = std::make_shared<std::packaged_task<void()>>([&options, &pools, chunk, chunkIndex, symbolCount]()
+        {
+            GenerateChunk(options, pools, chunkIndex, symbolCount, *chunk);
+        });
+
+        pendingChunks.emplace_back(chunk, task->get_future());
+        threadPool.Submit([task]() { (*task)(); });
+
+        while (pendingChunks.size() >= maxPendingChunks)
+        {
+            writeChunk();
+        }
+    }
+
+    while (!pendingChunks.empty())
+    {
+        writeChunk();
+    }
+
+    lines.close();
+    expected.close();
+
+    if (lines.fail() || expected.fail())
+    {
+        throw std::runtime_error("Failed to write the corpus files.");
+    }
+
+    return replacedCount;
+}
+
+std::vector<std::string> GenerateMangledNames(const CorpusOptions& options, size_t count)
+{
+    const NamePools pools = CreateNamePools(options.seed);
+    SymbolGenerator generator(options, pools, 0);
+    std::vector<std::string> names;
+    std::string line;
+    std::string mangledName;
+    std::string demangledName;
+
+    names.reserve(count);
+
+    for (int attempt = 0; names.size() < count; attempt++)
+    {
+        if (attempt == MaxGenerateAttempts)
+        {
+            throw std::runtime_error("The corpus options do not produce names that the demangler accepts.");
+        }
+
+        if (generator.Generate(line, mangledName, demangledName))
+        {
+            names.push_back(mangledName);
+            attempt = -1;
+        }
+    }
+
+    return names;
+}
@@ -0,0 +1,70 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ThreadPool.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The probabilities that control the shape of the generated names, each value is between 0 and 1.
+struct CorpusOptions
+{
+    uint64_t seed = 1;
+    size_t symbolCount = 1000000;
+    // The line forms.
+    double thunkProbability = 0.05;
+    double virtualPrototypeProbability = 0.05;
+    // The symbol kinds, the remaining symbols are ordinary methods.
+    double constructorProbability = 0.08;
+    double destructorProbability = 0.05;
+    double operatorProbability = 0.06;
+    double freeFunctionProbability = 0.05;
+    double constMethodProbability = 0.15;
+    // The class names.
+    double qualifiedClassProbability = 0.2;
+    double templateClassProbability = 0.15;
+    double templateValueParameterProbability = 0.25;
+    // The parameter types.
+    size_t maxParameters = 6;
+    size_t maxQualifiers = 4;
+    double classParameterProbability = 0.3;
+    double pointerProbability = 0.25;
+    double referenceProbability = 0.15;
+    double constProbability = 0.4;
+    double functionPointerProbability = 0.03;
+    double backReferenceProbability = 0.15;
+};
+
+// Parses a name=value setting, e.g. thunk=0.1 or maxParameters=8, and applies it to the options.
+// Throws an exception if the name is unknown or the value is invalid.
+void SetCorpusOption(CorpusOptions& options, std::string_view setting);
+
+// Writes a corpus of random GNU v2 (egcs-1.1.2) mangled names in the input file format to <prefix>.txt,
+// and the output of the reference demangler for each line to <prefix>.expected.txt.
+// The same options always produce the same corpus, independent of the number of threads.
+// Names that the reference demangler rejects are replaced, returns the number of replaced names.
+size_t GenerateCorpus(const CorpusOptions& options, const std::filesystem::path& outputPrefix, ThreadPool& threadPool);
+
+// Returns random mangled names that the reference demangler accepts, without the line prefixes.
+std::vector<std::string> GenerateMangledNames(const CorpusOptions& options, size_t count);
@@ -0,0 +1,346 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "CorpusVerifier.h"
+#include "DemangleCache.h"
+#include "DemangleUtil.h"
+#include "Demangler.h"
+#include "SymbolList.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+extern "C"
+{
+#include "demangle.h"
+#include "ReferenceDemangler.h"
+}
+
+static constexpr size_t VerifyChunkSize = 16384;
+
+namespace
+{
+    enum class VerifyPath
+    {
+        GoldenFile,
+        CplusDemangle,
+        IsPossibleMangledName,
+        TryDemangleClassic,
+        TryDemangleFixedWidthTypes,
+        GetDemangledLine,
+        DemangleCacheClassic,
+        DemangleCacheFixedWidthTypes,
+        DemanglerBatch,
+        DemanglerTree,
+        Count
+    };
+
+    constexpr size_t VerifyPathCount = static_cast<size_t>(VerifyPath::Count);
+
+    constexpr std::array<const char*, VerifyPathCount> VerifyPathNames
+    {
+        "expected file",
+        "cplus_demangle",
+        "IsPossibleMangledName",
+        "TryDemangle Classic",
+        "TryDemangle FixedWidthTypes",
+        "GetDemangledLine",
+        "DemangleCache Classic",
+        "DemangleCache FixedWidthTypes",
+        "Demangler::DemangleBatch",
+        "Demangler::DemangleToTree"
+    };
+
+    // An empty output means that the name was rejected, the demangler never returns an empty name.
+    struct Mismatch
+    {
+        size_t index = 0;
+        std::string expected;
+        std::string actual;
+    };
+
+    struct PathResult
+    {
+        size_t checkCount = 0;
+        size_t mismatchCount = 0;
+        // Only valid if mismatchCount is not zero.
+        Mismatch firstMismatch;
+    };
+
+    using ChunkResult = std::array<PathResult, VerifyPathCount>;
+
+    struct VerifyContext
+    {
+        const std::vector<std::string_view>& names;
+        const std::vector<std::string_view>& expectedLines;
+        DemangleCache& classicCache;
+        DemangleCache& fixedWidthTypesCache;
+    };
+
+    void Check(ChunkResult& result, VerifyPath path, size_t index, std::string_view expected, std::string_view actual)
+    {
+        PathResult& pathResult = result[static_cast<size_t>(path)];
+
+        pathResult.checkCount++;
+
+        if (expected != actual)
+        {
+            if (pathResult.mismatchCount == 0)
+            {
+                pathResult.firstMismatch = Mismatch{ index, std::string(expected), std::string(actual) };
+            }
+
+            pathResult.mismatchCount++;
+        }
+    }
+
+    void VerifyChunk(const VerifyContext& context, size_t begin, size_t end, ChunkResult& result)
+    {
+        TRACE_SPAN("verify chunk");
+
+        std::string reference;
+        std::string referenceFixedWidthTypes;
+        std::string demangled;
+        // The batch results are compared after the loop.
+        std::vector<std::string> batchReferences;
+        std::vector<std::string> treeReferences;
+
+        batchReferences.reserve(end - begin);
+        treeReferences.reserve(end - begin);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            // The names are null-terminated, see SymbolList.
+            const std::string_view name = context.names[i];
+            char* const referenceRaw = reference_cplus_demangle(name.data(), DMGL_PARAMS | DMGL_ANSI);
+
+            reference.assign(referenceRaw ? referenceRaw : "");
+            std::free(referenceRaw);
+
+            // Every other path calls cplus_demangle, this shows the changes in the demangler itself.
+            char* const raw = cplus_demangle(name.data(), DMGL_PARAMS | DMGL_ANSI);
+
+            Check(result, VerifyPath::CplusDemangle, i, reference, raw ? raw : "");
+            std::free(raw);
+
+            referenceFixedWidthTypes = reference;
+
+            if (!reference.empty())
+            {
+                ConvertToFixedWidthTypes(referenceFixedWidthTypes);
+            }
+
+            if (!context.expectedLines.empty())
+            {
+                Check(result, VerifyPath::GoldenFile, i, context.expectedLines[i], reference);
+            }
+
+            // The filter may only skip names that the demangler rejects.
+            Check(result, VerifyPath::IsPossibleMangledName, i, reference, IsPossibleMangledName(name) ? std::string_view(reference) : std::string_view());
+
+            demangled.clear();
+            Check(result, VerifyPath::TryDemangleClassic, i, reference, TryDemangle(name.data(), DemangleFormat::Classic, demangled) ? demangled : std::string());
+
+            demangled.clear();
+            Check(result, VerifyPath::TryDemangleFixedWidthTypes, i, referenceFixedWidthTypes,
+                TryDemangle(name.data(), DemangleFormat::FixedWidthTypes, demangled) ? demangled : std::string());
+
+            // GetDemangledLine returns the names that cannot be demangled unchanged.
+            Check(result, VerifyPath::GetDemangledLine, i, reference.empty() ? name : std::string_view(referenceFixedWidthTypes), GetDemangledLine(name.data()));
+
+            // The first lookup is usually a miss and the second lookup is always a hit.
+            for (int lookup = 0; lookup < 2; lookup++)
+            {
+                demangled.clear();
+                Check(result, VerifyPath::DemangleCacheClassic, i, reference,
+                    context.classicCache.TryDemangle(name, demangled) ? demangled : std::string());
+
+                demangled.clear();
+                Check(result, VerifyPath::DemangleCacheFixedWidthTypes, i, referenceFixedWidthTypes,
+                    context.fixedWidthTypesCache.TryDemangle(name, demangled) ? demangled : std::string());
+            }
+
+            batchReferences.push_back(std::move(referenceFixedWidthTypes));
+            treeReferences.push_back(std::move(reference));
+        }
+
+        Demangler demangler(DemangleFormat::FixedWidthTypes);
+        const std::vector<std::string_view> batchNames(context.names.begin() + begin, context.names.begin() + end);
+        std::vector<std::string_view> batchResults;
+
+        demangler.DemangleBatch(batchNames, batchResults);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            Check(result, VerifyPath::DemanglerBatch, i, batchReferences[i - begin], batchResults[i - begin]);
+        }
+
+        // The rendering of a tree must reproduce the demangler output exactly.
+        for (size_t i = begin; i < end; i++)
+        {
+            const DemangleTree* const tree = demangler.DemangleToTree(context.names[i]);
+
+            demangled.clear();
+
+            if (tree)
+            {
+                RenderDemangleTree(*tree, demangled);
+            }
+
+            Check(result, VerifyPath::DemanglerTree, i, treeReferences[i - begin], demangled);
+        }
+    }
+
+    // Returns the lines of the expected file, the views point into the data.
+    std::vector<std::string_view> SplitExpectedLines(const std::string& data)
+    {
+        std::vector<std::string_view> lines;
+        size_t lineStart = 0;
+
+        while (lineStart < data.size())
+        {
+            size_t lineEnd = data.find('\n', lineStart);
+
+            if (lineEnd == std::string::npos)
+            {
+                lineEnd = data.size();
+            }
+
+            size_t lineLength = lineEnd - lineStart;
+
+            if (lineLength > 0 && data[lineStart + lineLength - 1] == '\r')
+            {
+                lineLength--;
+            }
+
+            lines.emplace_back(data.data() + lineStart, lineLength);
+            lineStart = lineEnd + 1;
+        }
+
+        return lines;
+    }
+
+    void PrintOutput(const char* label, const std::string& output)
+    {
+        std::cout << "    " << label << ": " << (output.empty() ? "<rejected>" : output) << std::endl;
+    }
+}
+
+bool VerifyCorpus(const std::filesystem::path& input, const std::filesystem::path& expected, ThreadPool& threadPool)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const SymbolList symbols(input);
+    const std::vector<std::string_view>& names = symbols.GetNames();
+    std::string expectedData;
+    std::vector<std::string_view> expectedLines;
+
+    if (!expected.empty())
+    {
+        std::ifstream in(expected, std::ifstream::in | std::ifstream::binary);
+
+        if (!in)
+        {
+            throw std::runtime_error("Failed to open the file: " + expected.string());
+        }
+
+        expectedData.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        expectedLines = SplitExpectedLines(expectedData);
+
+        if (expectedLines.size() != names.size())
+        {
+            throw std::runtime_error("The expected file has " + std::to_string(expectedLines.size()) + " lines, the input has "
+                + std::to_string(names.size()) + " names: " + expected.string());
+        }
+    }
+
+    DemangleCache classicCache(DemangleFormat::Classic);
+    DemangleCache fixedWidthTypesCache(DemangleFormat::FixedWidthTypes);
+    const VerifyContext context{ names, expectedLines, classicCache, fixedWidthTypesCache };
+    const size_t chunkCount = (names.size() + VerifyChunkSize - 1) / VerifyChunkSize;
+    std::vector<ChunkResult> chunkResults(chunkCount);
+
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        const size_t begin = chunkIndex * VerifyChunkSize;
+        const size_t end = std::min(begin + VerifyChunkSize, names.size());
+
+        threadPool.Submit([&context, &chunkResults, chunkIndex, begin, end]()
+        {
+            VerifyChunk(context, begin, end, chunkResults[chunkIndex]);
+        });
+    }
+
+    threadPool.Wait();
+
+    bool passed = true;
+
+    for (size_t path = 0; path < VerifyPathCount; path++)
+    {
+        PathResult total;
+
+        // The chunks are in input order, so the first mismatch is in the first chunk that has one.
+        for (const ChunkResult& chunkResult : chunkResults)
+        {
+            const PathResult& pathResult = chunkResult[path];
+
+            if (total.mismatchCount == 0 && pathResult.mismatchCount != 0)
+            {
+                total.firstMismatch = pathResult.firstMismatch;
+            }
+
+            total.checkCount += pathResult.checkCount;
+            total.mismatchCount += pathResult.mismatchCount;
+        }
+
+        if (total.checkCount == 0)
+        {
+            continue;
+        }
+
+        std::cout << VerifyPathNames[path] << ": " << total.mismatchCount << " mismatch(es) in " << total.checkCount << " check(s)" << std::endl;
+
+        if (total.mismatchCount != 0)
+        {
+            const Mismatch& mismatch = total.firstMismatch;
+
+            std::cout << "    name " << (mismatch.index + 1) << ": " << names[mismatch.index] << std::endl;
+            PrintOutput("expected", mismatch.expected);
+            PrintOutput("actual", mismatch.actual);
+            passed = false;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Verified " << names.size() << " name(s) on " << threadPool.GetThreadCount() << " thread(s) in " << seconds << " s." << std::endl;
+
+    return passed;
+}
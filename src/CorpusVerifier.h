@@ -0,0 +1,37 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ThreadPool.h"
+#include <filesystem>
+
+// Runs the reference demangler and each of the demangling paths over the names of the input file, which can be
+// an ELF file or a text file in the class dump format, and reports the first name where a path differs from the
+// reference. The paths are cplus_demangle, TryDemangle (which uses the persistent cache when it is enabled),
+// GetDemangledLine, the IsPossibleMangledName filter, DemangleCache on a miss and on a hit, Demangler::DemangleBatch
+// and Demangler::DemangleToTree.
+// When an expected file is provided, e.g. one written by GenerateCorpus, the reference output is compared to it as well.
+// The names are checked in parallel, returns false if any path differs from the reference.
+// The reference is the unmodified egcs-1.1.2 demangler in reference/cplus-dem.c. cplus-dem.c rejects the valid names
+// whose nested types use more than 256 KB of stack or whose argument lists are longer than 1 MB, the reference accepts
+// them, so they are reported as mismatches. The reference can crash or hang on malformed names, use the fuzz harness
+// for those.
+bool VerifyCorpus(const std::filesystem::path& input, const std::filesystem::path& expected, ThreadPool& threadPool);
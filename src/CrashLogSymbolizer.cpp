@@ -0,0 +1,118 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "CrashLogSymbolizer.h"
+#include "TextFilter.h"
+#include "Tracing.h"
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+static constexpr std::string_view SymbolizedFileSuffix = ".symbolized.txt";
+
+namespace
+{
+    struct FileCloser
+    {
+        void operator()(std::FILE* file) const noexcept
+        {
+            std::fclose(file);
+        }
+    };
+
+    using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+    FilePtr OpenFile(const std::filesystem::path& path, bool write)
+    {
+#ifdef _WIN32
+        std::FILE* file = _wfopen(path.c_str(), write ? L"wb" : L"rb");
+#else
+        std::FILE* file = std::fopen(path.c_str(), write ? "wb" : "rb");
+#endif
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open the file: " + path.string());
+        }
+
+        return FilePtr(file);
+    }
+}
+
+void SymbolizeCrashLog(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    const AddressIndex& addressIndex,
+    DemangleCache& cache)
+{
+    FilePtr in = OpenFile(input, false);
+
+    if (output.empty())
+    {
+        DemangleText(in.get(), stdout, cache, &addressIndex);
+    }
+    else
+    {
+        FilePtr out = OpenFile(output, true);
+
+        DemangleText(in.get(), out.get(), cache, &addressIndex);
+
+        if (std::ferror(out.get()))
+        {
+            throw std::runtime_error("Failed to write the file: " + output.string());
+        }
+    }
+}
+
+size_t SymbolizeCrashLogDirectory(
+    const std::filesystem::path& directory,
+    const AddressIndex& addressIndex,
+    DemangleCache& cache,
+    ThreadPool& threadPool)
+{
+    std::vector<std::filesystem::path> logs;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory))
+    {
+        // Skip the output from a previous run.
+        if (entry.is_regular_file() && !entry.path().filename().string().ends_with(SymbolizedFileSuffix))
+        {
+            logs.push_back(entry.path());
+        }
+    }
+
+    for (const std::filesystem::path& log : logs)
+    {
+        threadPool.Submit([&log, &addressIndex, &cache]()
+        {
+            TRACE_SPAN("symbolize log");
+            std::filesystem::path output = log;
+            output += SymbolizedFileSuffix;
+
+            SymbolizeCrashLog(log, output, addressIndex, cache);
+        });
+    }
+
+    threadPool.Wait();
+
+    return logs.size();
+}
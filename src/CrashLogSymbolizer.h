@@ -0,0 +1,43 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "AddressIndex.h"
+#include "DemangleCache.h"
+#include "ThreadPool.h"
+#include <filesystem>
+
+// Symbolizes a crash log: hexadecimal addresses are resolved against the address index and any
+// mangled names in the text are demangled. When the output path is empty the result is written to stdout.
+void SymbolizeCrashLog(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    const AddressIndex& addressIndex,
+    DemangleCache& cache);
+
+// Symbolizes every file in the directory in parallel, the output for each log is
+// written next to it with a .symbolized.txt extension.
+// Returns the number of logs that were processed.
+size_t SymbolizeCrashLogDirectory(
+    const std::filesystem::path& directory,
+    const AddressIndex& addressIndex,
+    DemangleCache& cache,
+    ThreadPool& threadPool);
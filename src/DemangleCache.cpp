@@ -0,0 +1,89 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleCache.h"
+
+DemangleCache::DemangleCache(DemangleFormat format, size_t maxEntries)
+    : format(format),
+      maxEntriesPerShard(maxEntries > ShardCount ? maxEntries / ShardCount : 1),
+      shards(),
+      hitCount(0),
+      missCount(0)
+{
+}
+
+bool DemangleCache::TryDemangle(std::string_view mangledName, std::string& result)
+{
+    const size_t hash = StringHash{}(mangledName);
+    Shard& shard = shards[hash % ShardCount];
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto it = shard.entries.find(mangledName);
+
+        if (it != shard.entries.end())
+        {
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+
+            result.assign(it->second);
+            return !result.empty();
+        }
+    }
+
+    missCount.fetch_add(1, std::memory_order_relaxed);
+
+    // The demangler is called without holding the lock, the demangler requires a null-terminated string.
+    std::string key(mangledName);
+    std::string value;
+
+    if (!::TryDemangle(key.c_str(), format, value))
+    {
+        value.clear();
+    }
+
+    result.assign(value);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (shard.entries.size() >= maxEntriesPerShard)
+        {
+            // Start over instead of tracking the least recently used entries,
+            // the frequently used names are added back on their next lookup.
+            shard.entries.clear();
+        }
+
+        shard.entries.try_emplace(std::move(key), std::move(value));
+    }
+
+    return !result.empty();
+}
+
+uint64_t DemangleCache::GetHitCount() const noexcept
+{
+    return hitCount.load(std::memory_order_relaxed);
+}
+
+uint64_t DemangleCache::GetMissCount() const noexcept
+{
+    return missCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,73 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "DemangleUtil.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// A thread-safe cache of demangler results.
+// The cache is split into shards that each have their own lock, which keeps the
+// lock contention low when it is shared between worker threads.
+class DemangleCache
+{
+public:
+    explicit DemangleCache(DemangleFormat format, size_t maxEntries = 1 << 20);
+
+    // Demangles the name, returning false if it cannot be demangled.
+    // Names that the demangler rejected are cached as well.
+    bool TryDemangle(std::string_view mangledName, std::string& result);
+
+    uint64_t GetHitCount() const noexcept;
+    uint64_t GetMissCount() const noexcept;
+
+private:
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view value) const noexcept
+        {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        // An empty value indicates that the name could not be demangled.
+        std::unordered_map<std::string, std::string, StringHash, std::equal_to<>> entries;
+    };
+
+    static constexpr size_t ShardCount = 64;
+
+    const DemangleFormat format;
+    const size_t maxEntriesPerShard;
+    std::array<Shard, ShardCount> shards;
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+};
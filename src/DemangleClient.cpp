@@ -0,0 +1,278 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleClient.h"
+#include "LinePreprocessor.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+DemangleClient::DemangleClient(const std::filesystem::path& socketPath)
+    : socket(LocalSocket::Connect(socketPath))
+{
+}
+
+void DemangleClient::DemangleBatch(const std::vector<std::string_view>& names, DemangleFormat format, std::vector<std::string>& results)
+{
+    SendBatch(names, format);
+    ReceiveBatch(results);
+}
+
+bool DemangleClient::Demangle(std::string_view name, DemangleFormat format, std::string& result)
+{
+    std::vector<std::string> results;
+
+    DemangleBatch(std::vector<std::string_view>{ name }, format, results);
+
+    if (results.size() != 1 || results[0].empty())
+    {
+        return false;
+    }
+
+    result = std::move(results[0]);
+    return true;
+}
+
+void DemangleClient::SendBatch(const std::vector<std::string_view>& names, DemangleFormat format)
+{
+    sendBuffer.clear();
+    sendBuffer.push_back(static_cast<char>(format));
+    AppendUInt32(sendBuffer, static_cast<uint32_t>(names.size()));
+
+    for (const std::string_view& name : names)
+    {
+        AppendUInt32(sendBuffer, static_cast<uint32_t>(name.size()));
+        sendBuffer.append(name);
+    }
+
+    WriteFrame(socket, sendBuffer);
+}
+
+void DemangleClient::ReceiveBatch(std::vector<std::string>& results)
+{
+    if (!ReadFrame(socket, receiveBuffer))
+    {
+        throw std::runtime_error("The demangle server closed the connection.");
+    }
+
+    std::string_view response(receiveBuffer);
+    uint32_t count = 0;
+
+    if (!ReadUInt32(response, count) || count > response.size() / 4)
+    {
+        throw std::runtime_error("The demangle server sent an invalid response.");
+    }
+
+    results.resize(count);
+
+    for (std::string& result : results)
+    {
+        std::string_view value;
+
+        if (!ReadLengthPrefixedString(response, value))
+        {
+            throw std::runtime_error("The demangle server sent an invalid response.");
+        }
+
+        result.assign(value);
+    }
+}
+
+namespace
+{
+    // The output lines of the requests that are waiting for their response, in the order that the requests were sent.
+    class PendingBatches
+    {
+    public:
+        // Blocks while the maximum number of requests are in flight, returns false if the reader stopped.
+        bool Push(std::vector<std::string>&& lines)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            changed.wait(lock, [this]() { return batches.size() < MaxPendingBatches || stopped; });
+
+            if (stopped)
+            {
+                return false;
+            }
+
+            batches.push_back(std::move(lines));
+            changed.notify_all();
+            return true;
+        }
+
+        // Blocks until a request is in flight, returns false when no more requests will be sent.
+        bool Pop(std::vector<std::string>& lines)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            changed.wait(lock, [this]() { return !batches.empty() || finished || stopped; });
+
+            if (batches.empty() || stopped)
+            {
+                return false;
+            }
+
+            lines = std::move(batches.front());
+            batches.pop_front();
+            changed.notify_all();
+            return true;
+        }
+
+        // Called by the sender when all of the requests have been sent.
+        void Finish()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            finished = true;
+            changed.notify_all();
+        }
+
+        // Called by the reader when it fails, the sender stops sending requests.
+        void Stop()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            stopped = true;
+            changed.notify_all();
+        }
+
+    private:
+        // One request is demangled by the server while the next one is sent.
+        static constexpr size_t MaxPendingBatches = 2;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::vector<std::string>> batches;
+        bool finished = false;
+        bool stopped = false;
+    };
+
+    void WriteResponses(std::ostream& out, DemangleClient& client, PendingBatches& pendingBatches, std::exception_ptr& exception)
+    {
+        std::vector<std::string> lines;
+        std::vector<std::string> results;
+
+        try
+        {
+            while (pendingBatches.Pop(lines))
+            {
+                client.ReceiveBatch(results);
+
+                for (size_t i = 0; i < lines.size(); i++)
+                {
+                    // Names that cannot be demangled are written unchanged.
+                    out << (i < results.size() && !results[i].empty() ? results[i] : lines[i]) << '\n';
+                }
+            }
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+            pendingBatches.Stop();
+        }
+    }
+}
+
+void DemangleStreamWithServer(std::istream& in, std::ostream& out, DemangleClient& client)
+{
+    constexpr size_t BatchSize = 4096;
+
+    // The responses are read and written by a separate thread while the next requests are sent, if the
+    // same thread did both the client and the server could block each other writing to a full socket.
+    // The lines are preprocessed in the same way as the streaming mode, blank and malformed lines are sent
+    // as empty names, which the server cannot demangle, and written unchanged.
+    // Only the reader thread may use the output, reading std::cin would otherwise flush the tied std::cout.
+    std::ostream* const tiedStream = in.tie(nullptr);
+    PendingBatches pendingBatches;
+    std::exception_ptr readerException;
+    std::thread reader(WriteResponses, std::ref(out), std::ref(client), std::ref(pendingBatches), std::ref(readerException));
+
+    try
+    {
+        std::vector<std::string> batchLines;
+        // False for the blank and malformed lines.
+        std::vector<bool> lineHasName;
+        std::vector<std::string_view> names;
+        std::string line;
+        PreprocessedLine preprocessed;
+        bool readerRunning = true;
+
+        while (readerRunning && in.good())
+        {
+            batchLines.clear();
+            lineHasName.clear();
+
+            while (batchLines.size() < BatchSize && std::getline(in, line))
+            {
+                if (PreprocessLine(line, preprocessed) == LinePreprocessStatus::Success)
+                {
+                    // A name that cannot be demangled is written without the line prefixes, as in the streaming mode.
+                    batchLines.emplace_back(preprocessed.mangledName);
+                    lineHasName.push_back(true);
+                }
+                else
+                {
+                    batchLines.push_back(std::move(line));
+                    lineHasName.push_back(false);
+                }
+            }
+
+            if (batchLines.empty())
+            {
+                break;
+            }
+
+            // The views are created after the batch is complete, adding a line can move the other lines.
+            names.clear();
+
+            for (size_t i = 0; i < batchLines.size(); i++)
+            {
+                names.push_back(lineHasName[i] ? std::string_view(batchLines[i]) : std::string_view());
+            }
+
+            client.SendBatch(names, DemangleFormat::FixedWidthTypes);
+            readerRunning = pendingBatches.Push(std::move(batchLines));
+        }
+    }
+    catch (...)
+    {
+        pendingBatches.Finish();
+        reader.join();
+        in.tie(tiedStream);
+        throw;
+    }
+
+    pendingBatches.Finish();
+    reader.join();
+    in.tie(tiedStream);
+
+    if (readerException)
+    {
+        std::rethrow_exception(readerException);
+    }
+
+    out.flush();
+}
@@ -0,0 +1,59 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "DemangleProtocol.h"
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A client for the demangle server, see DemangleServer.h.
+// A client is not thread-safe, use one client per thread.
+class DemangleClient
+{
+public:
+    explicit DemangleClient(const std::filesystem::path& socketPath);
+
+    // Demangles the names in one request.
+    // A name that cannot be demangled has an empty result.
+    void DemangleBatch(const std::vector<std::string_view>& names, DemangleFormat format, std::vector<std::string>& results);
+
+    // Demangles a single name, returns false if it cannot be demangled.
+    bool Demangle(std::string_view name, DemangleFormat format, std::string& result);
+
+    // Sends a request without waiting for the response, the responses are read with
+    // ReceiveBatch in the order that the requests were sent.
+    // One thread can send while another thread receives, the server only reads the next
+    // request after its response to the previous one has been read.
+    void SendBatch(const std::vector<std::string_view>& names, DemangleFormat format);
+    void ReceiveBatch(std::vector<std::string>& results);
+
+private:
+    LocalSocket socket;
+    std::string sendBuffer;
+    std::string receiveBuffer;
+};
+
+// Demangles the names read from the input using the server, the output matches the streaming mode.
+void DemangleStreamWithServer(std::istream& in, std::ostream& out, DemangleClient& client);
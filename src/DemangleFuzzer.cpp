@@ -0,0 +1,535 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleFuzzer.h"
+#include "CorpusGenerator.h"
+#include "DemangleUtil.h"
+#include "Demangler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+extern "C"
+{
+#include "demangle.h"
+}
+
+static constexpr int DemangleOptions = DMGL_PARAMS | DMGL_ANSI;
+static constexpr size_t SeedNameCount = 2000;
+static constexpr size_t MaxInputLength = 4096;
+static constexpr size_t MaxPoolSize = 10000;
+// Shorter times are within the noise of the clock and the scheduler.
+static constexpr double MinimumSlowNanoseconds = 5000;
+// Smaller allocations are within the fixed buffer sizes of the demangler.
+static constexpr uint64_t MinimumSlowAllocatedBytes = 4096;
+static constexpr int ConfirmRepeatCount = 9;
+static constexpr size_t MaxMinimizeMeasurements = 2000;
+static constexpr size_t MaxReportedMismatches = 10;
+static constexpr std::string_view CorpusFileExtension = ".slow.txt";
+
+// The characters that appear in GNU v2 mangled names, the mutations only insert these.
+static constexpr std::string_view MangledNameAlphabet = "0123456789_$.QtZTNKBXYPRCFUSJMOAGHVvcsilxfdrbwmaeno";
+
+namespace
+{
+    struct InputCost
+    {
+        double nanoseconds;
+        size_t outputLength;
+        uint64_t allocatedBytes;
+    };
+
+    // The median cost per byte of input and output of the generated names.
+    struct LinearCost
+    {
+        double nanosecondsPerByte;
+        // Zero when the allocations are not counted.
+        double allocatedBytesPerByte;
+    };
+
+    InputCost MeasureInput(const std::string& input, int repeatCount)
+    {
+        InputCost cost{ 0, 0, 0 };
+
+#ifdef DEMANGLE_ALLOC_STATS
+        demangle_alloc_stats stats{};
+        cplus_demangle_alloc_stats(&stats, 1);
+#endif
+
+        for (int repeat = 0; repeat < repeatCount; repeat++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            char* demangled = cplus_demangle(input.c_str(), DemangleOptions);
+            const auto end = std::chrono::steady_clock::now();
+
+            cost.outputLength = demangled ? std::strlen(demangled) : 0;
+            std::free(demangled);
+
+            const double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+
+            if (repeat == 0 || nanoseconds < cost.nanoseconds)
+            {
+                cost.nanoseconds = nanoseconds;
+            }
+        }
+
+#ifdef DEMANGLE_ALLOC_STATS
+        cplus_demangle_alloc_stats(&stats, 1);
+        cost.allocatedBytes = stats.allocated_bytes / static_cast<uint64_t>(repeatCount);
+#endif
+
+        return cost;
+    }
+
+    // The cost relative to the linear cost of the input and output length, a name that expands
+    // to a long output (e.g. repeated back-references) is not slow if its time follows the output.
+    double GetRelativeCost(const InputCost& cost, size_t length, const LinearCost& linearCost)
+    {
+        const size_t bytes = std::max<size_t>(length + cost.outputLength, 1);
+
+        return cost.nanoseconds / (linearCost.nanosecondsPerByte * static_cast<double>(bytes));
+    }
+
+    // The allocated bytes relative to the linear allocation of the input and output length,
+    // zero when the allocations are not counted.
+    double GetRelativeAllocation(const InputCost& cost, size_t length, const LinearCost& linearCost)
+    {
+        if (linearCost.allocatedBytesPerByte <= 0)
+        {
+            return 0;
+        }
+
+        const size_t bytes = std::max<size_t>(length + cost.outputLength, 1);
+
+        return static_cast<double>(cost.allocatedBytes) / (linearCost.allocatedBytesPerByte * static_cast<double>(bytes));
+    }
+
+    // An input is slow when either its time or its allocated memory grows faster than its input and output length.
+    bool IsSlow(const InputCost& cost, size_t length, const LinearCost& linearCost, double slowFactor)
+    {
+        return (cost.nanoseconds >= MinimumSlowNanoseconds && GetRelativeCost(cost, length, linearCost) > slowFactor)
+            || (cost.allocatedBytes >= MinimumSlowAllocatedBytes && GetRelativeAllocation(cost, length, linearCost) > slowFactor);
+    }
+
+    double GetMedian(std::vector<double>& values)
+    {
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+    // Returns the median time and allocation per byte of the seed names.
+    LinearCost CalibrateLinearCost(const std::vector<std::string>& seeds)
+    {
+        std::vector<double> nanosecondsPerByte;
+        std::vector<double> allocatedBytesPerByte;
+        nanosecondsPerByte.reserve(seeds.size());
+        allocatedBytesPerByte.reserve(seeds.size());
+
+        for (const std::string& seed : seeds)
+        {
+            const InputCost cost = MeasureInput(seed, 3);
+            const double bytes = static_cast<double>(seed.size() + cost.outputLength);
+
+            nanosecondsPerByte.push_back(cost.nanoseconds / bytes);
+            allocatedBytesPerByte.push_back(static_cast<double>(cost.allocatedBytes) / bytes);
+        }
+
+        return LinearCost{ GetMedian(nanosecondsPerByte), GetMedian(allocatedBytesPerByte) };
+    }
+
+    std::vector<std::string> CreateSeedNames(uint64_t seed)
+    {
+        CorpusOptions corpusOptions;
+        corpusOptions.seed = seed;
+        // Deeper names give the mutations more back-references and qualifiers to work with.
+        corpusOptions.maxQualifiers = 9;
+        corpusOptions.backReferenceProbability = 0.3;
+
+        return GenerateMangledNames(corpusOptions, SeedNameCount);
+    }
+
+    class InputMutator
+    {
+    public:
+        explicit InputMutator(uint64_t seed) : rng(seed)
+        {
+        }
+
+        std::string Mutate(const std::string& input, const std::string& other)
+        {
+            std::string result = input;
+            const size_t mutationCount = 1 + Uniform(3);
+
+            for (size_t i = 0; i < mutationCount && !result.empty(); i++)
+            {
+                const size_t position = Uniform(result.size());
+
+                switch (Uniform(6))
+                {
+                case 0:
+                    result[position] = RandomCharacter();
+                    break;
+                case 1:
+                    result.insert(position, 1, RandomCharacter());
+                    break;
+                case 2:
+                    result.erase(position, 1 + Uniform(std::min<size_t>(8, result.size() - position)));
+                    break;
+                case 3:
+                {
+                    // Repeating a part of the name finds the constructs whose cost grows with their count.
+                    const size_t length = 1 + Uniform(std::min<size_t>(16, result.size() - position));
+                    const std::string part = result.substr(position, length);
+                    const size_t repeatCount = 2 + Uniform(15);
+
+                    for (size_t repeat = 0; repeat < repeatCount; repeat++)
+                    {
+                        result.insert(position, part);
+                    }
+                    break;
+                }
+                case 4:
+                    // Splice the start of this name with the end of another name.
+                    result = result.substr(0, position) + other.substr(Uniform(other.size()));
+                    break;
+                default:
+                    // Large length prefixes and back-reference indices.
+                    result.insert(position, std::to_string(Uniform(2) ? Uniform(10) : Uniform(100000)));
+                    break;
+                }
+            }
+
+            if (result.size() > MaxInputLength)
+            {
+                result.resize(MaxInputLength);
+            }
+
+            return result;
+        }
+
+        size_t Uniform(size_t count)
+        {
+            return count == 0 ? 0 : static_cast<size_t>(rng() % count);
+        }
+
+    private:
+        char RandomCharacter()
+        {
+            return MangledNameAlphabet[Uniform(MangledNameAlphabet.size())];
+        }
+
+        std::mt19937_64 rng;
+    };
+
+    // Removes parts of the input while it stays slow, this keeps the saved inputs short and readable.
+    std::string MinimizeSlowInput(std::string input, const LinearCost& linearCost, double slowFactor)
+    {
+        size_t measurementCount = 0;
+
+        for (size_t chunkSize = input.size() / 2; chunkSize > 0 && measurementCount < MaxMinimizeMeasurements; chunkSize /= 2)
+        {
+            for (size_t start = 0; start + chunkSize <= input.size() && measurementCount < MaxMinimizeMeasurements;)
+            {
+                std::string candidate = input;
+                candidate.erase(start, chunkSize);
+
+                measurementCount++;
+
+                if (!candidate.empty() && IsSlow(MeasureInput(candidate, 3), candidate.size(), linearCost, slowFactor))
+                {
+                    input = std::move(candidate);
+                }
+                else
+                {
+                    start += chunkSize;
+                }
+            }
+        }
+
+        return input;
+    }
+
+    std::filesystem::path GetCorpusFilePath(const std::filesystem::path& corpusDirectory, std::string_view input)
+    {
+        // FNV-1a, the file name only has to be stable for the same input.
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (const char c : input)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+        }
+
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << hash << CorpusFileExtension;
+
+        return corpusDirectory / name.str();
+    }
+
+    // The corpus files contain the input on the first line, its relative cost on the second line and its relative
+    // allocation on the third line. The third line is only written by builds that count the allocations.
+    void WriteCorpusFile(const std::filesystem::path& path, const std::string& input, double relativeCost, double relativeAllocation)
+    {
+        std::ofstream out(path, std::ofstream::out | std::ofstream::trunc);
+
+        out << input << '\n' << relativeCost << '\n';
+
+        if (relativeAllocation > 0)
+        {
+            out << relativeAllocation << '\n';
+        }
+
+        out.close();
+
+        if (out.fail())
+        {
+            throw std::runtime_error("Failed to write the corpus file: " + path.string());
+        }
+    }
+
+    // Returns false if the demangling paths disagree, demangled is set to whether the input is a valid name.
+    bool CheckPaths(const std::string& input, Demangler& demangler, std::string& classic, std::string& fixedWidthTypes, bool& demangled)
+    {
+        char* raw = cplus_demangle(input.c_str(), DemangleOptions);
+        const bool classicDemangled = TryDemangle(input.c_str(), DemangleFormat::Classic, classic);
+        bool matches = (raw != nullptr) == classicDemangled && (!raw || classic == raw);
+
+        demangled = raw != nullptr;
+
+        std::free(raw);
+
+        const bool fixedWidthDemangled = TryDemangle(input.c_str(), DemangleFormat::FixedWidthTypes, fixedWidthTypes);
+        const std::string_view libraryResult = demangler.Demangle(input);
+
+        if (fixedWidthDemangled ? libraryResult != fixedWidthTypes : !libraryResult.empty())
+        {
+            matches = false;
+        }
+
+        return matches;
+    }
+}
+
+FuzzResult RunDemangleFuzzer(const std::filesystem::path& corpusDirectory, const FuzzOptions& options)
+{
+    std::filesystem::create_directories(corpusDirectory);
+
+    std::vector<std::string> pool = CreateSeedNames(options.seed);
+    const LinearCost linearCost = CalibrateLinearCost(pool);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Linear cost: " << linearCost.nanosecondsPerByte << " ns/byte";
+#ifdef DEMANGLE_ALLOC_STATS
+    std::cout << ", " << linearCost.allocatedBytesPerByte << " allocated bytes/byte";
+#endif
+    std::cout << ", slow inputs cost more than " << options.slowFactor << " times as much" << std::endl;
+
+    InputMutator mutator(options.seed);
+    Demangler demangler(DemangleFormat::FixedWidthTypes);
+    FuzzResult result;
+    std::string classic;
+    std::string fixedWidthTypes;
+
+    for (size_t iteration = 0; iteration < options.iterations; iteration++)
+    {
+        const std::string input = mutator.Mutate(pool[mutator.Uniform(pool.size())], pool[mutator.Uniform(pool.size())]);
+
+        if (input.empty())
+        {
+            continue;
+        }
+
+        result.inputCount++;
+
+        bool demangled = false;
+
+        if (!CheckPaths(input, demangler, classic, fixedWidthTypes, demangled))
+        {
+            if (result.mismatchCount < MaxReportedMismatches)
+            {
+                std::cout << "Mismatch: " << input << std::endl;
+            }
+
+            result.mismatchCount++;
+        }
+
+        // The Demangler results are kept in its arena until they are cleared.
+        if ((iteration % 1024) == 0)
+        {
+            demangler.ClearResults();
+        }
+
+        const InputCost cost = MeasureInput(input, 1);
+
+        if (!demangled)
+        {
+            result.rejectedCount++;
+        }
+        else if (pool.size() < MaxPoolSize)
+        {
+            pool.push_back(input);
+        }
+        else
+        {
+            pool[mutator.Uniform(pool.size())] = input;
+        }
+
+        if (!IsSlow(cost, input.size(), linearCost, options.slowFactor)
+            || !IsSlow(MeasureInput(input, ConfirmRepeatCount), input.size(), linearCost, options.slowFactor))
+        {
+            continue;
+        }
+
+        const std::string minimized = MinimizeSlowInput(input, linearCost, options.slowFactor);
+        const std::filesystem::path path = GetCorpusFilePath(corpusDirectory, minimized);
+
+        if (std::filesystem::exists(path))
+        {
+            continue;
+        }
+
+        const InputCost minimizedCost = MeasureInput(minimized, ConfirmRepeatCount);
+
+        // A time slice lost to the scheduler can make a fast input look slow in every earlier measurement.
+        if (!IsSlow(minimizedCost, minimized.size(), linearCost, options.slowFactor))
+        {
+            continue;
+        }
+
+        const double relativeCost = GetRelativeCost(minimizedCost, minimized.size(), linearCost);
+        const double relativeAllocation = GetRelativeAllocation(minimizedCost, minimized.size(), linearCost);
+
+        WriteCorpusFile(path, minimized, relativeCost, relativeAllocation);
+        result.savedCount++;
+
+        std::cout << "Slow input: " << minimizedCost.nanoseconds << " ns, length " << minimized.size()
+                  << ", " << relativeCost << " times the linear cost";
+#ifdef DEMANGLE_ALLOC_STATS
+        std::cout << ", " << minimizedCost.allocatedBytes << " bytes allocated, " << relativeAllocation << " times the linear allocation";
+#endif
+        std::cout << ": " << minimized << std::endl;
+    }
+
+    return result;
+}
+
+bool CheckDemangleComplexity(const std::filesystem::path& corpusDirectory, double tolerance)
+{
+    std::vector<std::filesystem::path> corpusFiles;
+
+    for (const auto& entry : std::filesystem::directory_iterator(corpusDirectory))
+    {
+        if (entry.is_regular_file() && entry.path().filename().string().ends_with(CorpusFileExtension))
+        {
+            corpusFiles.push_back(entry.path());
+        }
+    }
+
+    std::sort(corpusFiles.begin(), corpusFiles.end());
+
+    const LinearCost linearCost = CalibrateLinearCost(CreateSeedNames(FuzzOptions().seed));
+    bool passed = true;
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (const std::filesystem::path& path : corpusFiles)
+    {
+        std::ifstream in(path);
+        std::string input;
+        double savedRelativeCost = 0;
+        double savedRelativeAllocation = 0;
+
+        if (!std::getline(in, input) || !(in >> savedRelativeCost) || input.empty())
+        {
+            throw std::runtime_error("The corpus file is invalid: " + path.string());
+        }
+
+        // The relative allocation is optional, it is only written by builds that count the allocations.
+        if (!(in >> savedRelativeAllocation))
+        {
+            savedRelativeAllocation = 0;
+        }
+
+        const InputCost cost = MeasureInput(input, ConfirmRepeatCount);
+        const double relativeCost = GetRelativeCost(cost, input.size(), linearCost);
+        const double relativeAllocation = GetRelativeAllocation(cost, input.size(), linearCost);
+        bool regressed = relativeCost > savedRelativeCost * (1.0 + tolerance);
+
+        std::cout << path.filename().string() << ": " << relativeCost << " times the linear cost, saved " << savedRelativeCost;
+
+        // The allocations are only compared by builds that count them.
+        if (relativeAllocation > 0 && savedRelativeAllocation > 0)
+        {
+            regressed = regressed || relativeAllocation > savedRelativeAllocation * (1.0 + tolerance);
+
+            std::cout << ", " << relativeAllocation << " times the linear allocation, saved " << savedRelativeAllocation;
+        }
+
+        std::cout << (regressed ? " REGRESSION" : "") << std::endl;
+
+        if (regressed)
+        {
+            passed = false;
+        }
+    }
+
+    std::cout << "Checked " << corpusFiles.size() << " input(s)." << std::endl;
+
+    return passed;
+}
+
+#ifdef SC3K_LIBFUZZER
+
+// The libFuzzer entry point, AFL++ can use it through its libFuzzer driver.
+// Build the library sources without main.cpp, with -DSC3K_LIBFUZZER -fsanitize=fuzzer,address,undefined.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // The demangler reads null-terminated strings, the input ends at the first null.
+    const char* const text = reinterpret_cast<const char*>(data);
+    const std::string input(text, std::find(text, text + std::min(size, MaxInputLength), '\0'));
+
+    static Demangler demangler(DemangleFormat::FixedWidthTypes);
+    std::string classic;
+    std::string fixedWidthTypes;
+    bool demangled = false;
+
+    // libFuzzer saves the input that aborts.
+    if (!CheckPaths(input, demangler, classic, fixedWidthTypes, demangled))
+    {
+        std::abort();
+    }
+
+    demangler.ClearResults();
+
+    return 0;
+}
+
+#endif
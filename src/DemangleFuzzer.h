@@ -0,0 +1,56 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+struct FuzzOptions
+{
+    uint64_t seed = 1;
+    size_t iterations = 100000;
+    // An input is slow when its time or allocation is larger than this multiple of the linear cost of its input
+    // and output length, the linear cost is the median time or allocation per byte of the generated seed names.
+    double slowFactor = 20.0;
+};
+
+struct FuzzResult
+{
+    size_t inputCount = 0;
+    size_t rejectedCount = 0;
+    size_t savedCount = 0;
+    // The inputs where the demangling paths disagree, see RunDemangleFuzzer.
+    size_t mismatchCount = 0;
+};
+
+// Runs mutated mangled names through the demangler. Each input is checked three ways:
+// - The Classic TryDemangle output must match the raw cplus_demangle output.
+// - The Demangler library output must match the FixedWidthTypes TryDemangle output.
+// - The time must grow at most linearly with the input and output length, as must the allocated bytes
+//   in a build with DEMANGLE_ALLOC_STATS defined.
+// A slow input is minimized and saved to the corpus directory, with its cost relative to the linear cost.
+// Build with -fsanitize=address,undefined to also check the memory safety of the demangler.
+FuzzResult RunDemangleFuzzer(const std::filesystem::path& corpusDirectory, const FuzzOptions& options);
+
+// Measures the inputs saved by the fuzzer again, returns false if the relative cost of any input
+// is more than (1 + tolerance) times its saved cost.
+bool CheckDemangleComplexity(const std::filesystem::path& corpusDirectory, double tolerance);
@@ -0,0 +1,389 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleProtocol.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <WinSock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static constexpr NativeSocket InvalidSocket = INVALID_SOCKET;
+
+static void InitializeWinsock()
+{
+    static const bool initialized = []()
+    {
+        WSADATA data{};
+
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+        {
+            throw std::runtime_error("Failed to initialize Winsock.");
+        }
+
+        return true;
+    }();
+
+    static_cast<void>(initialized);
+}
+#else
+static constexpr NativeSocket InvalidSocket = -1;
+
+static void InitializeWinsock()
+{
+}
+#endif
+
+static sockaddr_un GetSocketAddress(const std::filesystem::path& path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    const std::string pathString = path.string();
+
+    if (pathString.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("The socket path is too long: " + pathString);
+    }
+
+    pathString.copy(address.sun_path, pathString.size());
+
+    return address;
+}
+
+static NativeSocket CreateSocket()
+{
+    InitializeWinsock();
+
+    const NativeSocket result = static_cast<NativeSocket>(::socket(AF_UNIX, SOCK_STREAM, 0));
+
+    if (result == InvalidSocket)
+    {
+        throw std::runtime_error("Failed to create the socket.");
+    }
+
+    return result;
+}
+
+LocalSocket::LocalSocket() noexcept
+    : socket(InvalidSocket)
+{
+}
+
+LocalSocket::LocalSocket(NativeSocket socket) noexcept
+    : socket(socket)
+{
+}
+
+LocalSocket::~LocalSocket()
+{
+    Close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+    : socket(std::exchange(other.socket, InvalidSocket))
+{
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        socket = std::exchange(other.socket, InvalidSocket);
+    }
+
+    return *this;
+}
+
+void LocalSocket::Close() noexcept
+{
+    if (socket != InvalidSocket)
+    {
+#ifdef _WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+        socket = InvalidSocket;
+    }
+}
+
+LocalSocket LocalSocket::Connect(const std::filesystem::path& path)
+{
+    const sockaddr_un address = GetSocketAddress(path);
+    LocalSocket result(CreateSocket());
+
+    if (connect(result.socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        throw std::runtime_error("Failed to connect to the demangle server: " + path.string());
+    }
+
+    return result;
+}
+
+// Returns true if the path is a Unix domain socket file.
+static bool IsSocketFile(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    // The socket files are reparse points with the AF_UNIX tag, std::filesystem does not report them as sockets.
+    WIN32_FIND_DATAW findData{};
+    const HANDLE find = FindFirstFileW(path.c_str(), &findData);
+
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    FindClose(find);
+
+    return (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0 && findData.dwReserved0 == IO_REPARSE_TAG_AF_UNIX;
+#else
+    return std::filesystem::is_socket(path);
+#endif
+}
+
+LocalSocket LocalSocket::Listen(const std::filesystem::path& path)
+{
+    const sockaddr_un address = GetSocketAddress(path);
+
+    if (std::filesystem::exists(path))
+    {
+        // Never remove a file that is not a socket, e.g. when the arguments were mixed up.
+        if (!IsSocketFile(path))
+        {
+            throw std::runtime_error("The socket path already exists and is not a socket: " + path.string());
+        }
+
+        bool serverRunning = false;
+
+        try
+        {
+            LocalSocket::Connect(path);
+            serverRunning = true;
+        }
+        catch (const std::runtime_error&)
+        {
+            // Nothing is listening on the socket, it was left behind by a server that was terminated.
+            std::filesystem::remove(path);
+        }
+
+        if (serverRunning)
+        {
+            throw std::runtime_error("A demangle server is already running on " + path.string());
+        }
+    }
+
+    LocalSocket result(CreateSocket());
+
+    if (bind(result.socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || listen(result.socket, SOMAXCONN) != 0)
+    {
+        throw std::runtime_error("Failed to listen on the socket: " + path.string());
+    }
+
+    return result;
+}
+
+LocalSocket LocalSocket::Accept()
+{
+    while (true)
+    {
+        const NativeSocket client = static_cast<NativeSocket>(accept(socket, nullptr, nullptr));
+
+        if (client != InvalidSocket)
+        {
+            return LocalSocket(client);
+        }
+
+#ifndef _WIN32
+        if (errno == EINTR || errno == ECONNABORTED)
+        {
+            continue;
+        }
+#endif
+        throw std::runtime_error("Failed to accept a connection.");
+    }
+}
+
+bool LocalSocket::ReadExact(void* buffer, size_t size)
+{
+    char* const data = static_cast<char*>(buffer);
+    size_t offset = 0;
+
+    while (offset < size)
+    {
+        const int chunkSize = static_cast<int>(std::min<size_t>(size - offset, 1 << 30));
+        const auto bytesRead = recv(socket, data + offset, chunkSize, 0);
+
+        if (bytesRead == 0)
+        {
+            if (offset == 0)
+            {
+                return false;
+            }
+
+            throw std::runtime_error("The connection was closed in the middle of a frame.");
+        }
+        else if (bytesRead < 0)
+        {
+#ifndef _WIN32
+            if (errno == EINTR)
+            {
+                continue;
+            }
+#endif
+            throw std::runtime_error("Failed to read from the socket.");
+        }
+
+        offset += static_cast<size_t>(bytesRead);
+    }
+
+    return true;
+}
+
+void LocalSocket::WriteAll(const void* buffer, size_t size)
+{
+#ifdef MSG_NOSIGNAL
+    // Report a closed connection as an error instead of raising SIGPIPE.
+    constexpr int flags = MSG_NOSIGNAL;
+#else
+    constexpr int flags = 0;
+#endif
+    const char* const data = static_cast<const char*>(buffer);
+    size_t offset = 0;
+
+    while (offset < size)
+    {
+        const int chunkSize = static_cast<int>(std::min<size_t>(size - offset, 1 << 30));
+        const auto bytesWritten = send(socket, data + offset, chunkSize, flags);
+
+        if (bytesWritten < 0)
+        {
+#ifndef _WIN32
+            if (errno == EINTR)
+            {
+                continue;
+            }
+#endif
+            throw std::runtime_error("Failed to write to the socket.");
+        }
+
+        offset += static_cast<size_t>(bytesWritten);
+    }
+}
+
+bool ReadFrame(LocalSocket& socket, std::string& payload)
+{
+    uint8_t header[4];
+
+    if (!socket.ReadExact(header, sizeof(header)))
+    {
+        return false;
+    }
+
+    const uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | (static_cast<uint32_t>(header[3]) << 24);
+
+    if (size > MaxDemangleFrameSize)
+    {
+        throw std::runtime_error("The frame is larger than the maximum size.");
+    }
+
+    payload.resize(size);
+
+    if (size > 0 && !socket.ReadExact(payload.data(), size))
+    {
+        throw std::runtime_error("The connection was closed in the middle of a frame.");
+    }
+
+    return true;
+}
+
+void WriteFrame(LocalSocket& socket, std::string_view payload)
+{
+    if (payload.size() > MaxDemangleFrameSize)
+    {
+        throw std::runtime_error("The frame is larger than the maximum size.");
+    }
+
+    std::string header;
+    AppendUInt32(header, static_cast<uint32_t>(payload.size()));
+
+    socket.WriteAll(header.data(), header.size());
+    socket.WriteAll(payload.data(), payload.size());
+}
+
+void AppendUInt32(std::string& buffer, uint32_t value)
+{
+    const char bytes[4]
+    {
+        static_cast<char>(value & 0xff),
+        static_cast<char>((value >> 8) & 0xff),
+        static_cast<char>((value >> 16) & 0xff),
+        static_cast<char>((value >> 24) & 0xff)
+    };
+
+    buffer.append(bytes, sizeof(bytes));
+}
+
+bool ReadUInt32(std::string_view& data, uint32_t& value) noexcept
+{
+    if (data.size() < 4)
+    {
+        return false;
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+
+    value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    data.remove_prefix(4);
+
+    return true;
+}
+
+bool ReadLengthPrefixedString(std::string_view& data, std::string_view& value) noexcept
+{
+    std::string_view remaining = data;
+    uint32_t length = 0;
+
+    if (!ReadUInt32(remaining, length) || remaining.size() < length)
+    {
+        return false;
+    }
+
+    value = remaining.substr(0, length);
+    remaining.remove_prefix(length);
+    data = remaining;
+
+    return true;
+}
@@ -0,0 +1,88 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "DemangleUtil.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// The demangle server protocol uses length-prefixed frames on a Unix domain socket.
+// All integers are 32-bit little-endian values.
+//
+// Frame:    uint32 payloadLength, payload
+// Request:  uint8 format (DemangleFormat), uint32 nameCount, nameCount * (uint32 length, name bytes)
+// Response: uint32 nameCount, nameCount * (uint32 length, demangled name bytes)
+//
+// A response name length of zero indicates that the name could not be demangled, or that the demangled name
+// did not fit in the rest of the response frame.
+// A client can send several requests before reading the responses, they are answered in order.
+// The server closes the connection when it receives a malformed request, and closes new connections without
+// reading them when it is already serving its maximum number of connections.
+
+constexpr uint32_t MaxDemangleFrameSize = 64 * 1024 * 1024;
+
+#ifdef _WIN32
+using NativeSocket = uintptr_t;
+#else
+using NativeSocket = int;
+#endif
+
+// A stream socket that is connected to a local (AF_UNIX) address.
+class LocalSocket
+{
+public:
+    LocalSocket() noexcept;
+    explicit LocalSocket(NativeSocket socket) noexcept;
+    ~LocalSocket();
+
+    LocalSocket(LocalSocket&& other) noexcept;
+    LocalSocket& operator=(LocalSocket&& other) noexcept;
+
+    LocalSocket(const LocalSocket&) = delete;
+    LocalSocket& operator=(const LocalSocket&) = delete;
+
+    static LocalSocket Connect(const std::filesystem::path& path);
+    // Creates a listening socket, a stale socket file that is left over from a previous server is replaced.
+    static LocalSocket Listen(const std::filesystem::path& path);
+
+    LocalSocket Accept();
+
+    // Returns false if the connection was closed before any data was read.
+    bool ReadExact(void* buffer, size_t size);
+    void WriteAll(const void* buffer, size_t size);
+
+private:
+    void Close() noexcept;
+
+    NativeSocket socket;
+};
+
+// Returns false if the connection was closed at a frame boundary.
+bool ReadFrame(LocalSocket& socket, std::string& payload);
+void WriteFrame(LocalSocket& socket, std::string_view payload);
+
+void AppendUInt32(std::string& buffer, uint32_t value);
+// Reads a value from the start of the data and advances it, returns false if the data is too short.
+bool ReadUInt32(std::string_view& data, uint32_t& value) noexcept;
+// Reads a length-prefixed string from the start of the data and advances it.
+bool ReadLengthPrefixedString(std::string_view& data, std::string_view& value) noexcept;
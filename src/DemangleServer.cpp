@@ -0,0 +1,250 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleServer.h"
+#include "DemangleCache.h"
+#include "DemangleProtocol.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Batches with more names than this are split into chunks that are demangled on the thread pool.
+static constexpr size_t ServerChunkSize = 1024;
+// Each connection is served by its own thread, connections above this limit are closed when they are accepted.
+static constexpr size_t MaxServerConnections = 64;
+
+namespace
+{
+    struct ServerState
+    {
+        ThreadPool& threadPool;
+        DemangleCache classicCache;
+        DemangleCache fixedWidthTypesCache;
+        std::atomic<size_t> connectionCount;
+
+        explicit ServerState(ThreadPool& threadPool)
+            : threadPool(threadPool),
+              classicCache(DemangleFormat::Classic),
+              fixedWidthTypesCache(DemangleFormat::FixedWidthTypes),
+              connectionCount(0)
+        {
+        }
+    };
+
+    void DemangleNames(const std::vector<std::string_view>& names, size_t start, size_t end, DemangleCache& cache, std::vector<std::string>& results)
+    {
+        TRACE_SPAN("demangle batch");
+        for (size_t i = start; i < end; i++)
+        {
+            if (!cache.TryDemangle(names[i], results[i]))
+            {
+                results[i].clear();
+            }
+        }
+    }
+
+    // Returns false if the request is malformed.
+    bool ProcessRequest(std::string_view request, ServerState& state, std::vector<std::string_view>& names, std::vector<std::string>& results, std::string& response)
+    {
+        if (request.empty())
+        {
+            return false;
+        }
+
+        const uint8_t format = static_cast<uint8_t>(request[0]);
+        request.remove_prefix(1);
+
+        if (format != static_cast<uint8_t>(DemangleFormat::Classic) && format != static_cast<uint8_t>(DemangleFormat::FixedWidthTypes))
+        {
+            return false;
+        }
+
+        DemangleCache& cache = format == static_cast<uint8_t>(DemangleFormat::Classic) ? state.classicCache : state.fixedWidthTypesCache;
+        uint32_t nameCount = 0;
+
+        // Each name takes at least 4 bytes, this rejects a bogus count before anything is allocated.
+        if (!ReadUInt32(request, nameCount) || nameCount > request.size() / 4)
+        {
+            return false;
+        }
+
+        names.resize(nameCount);
+
+        for (std::string_view& name : names)
+        {
+            if (!ReadLengthPrefixedString(request, name))
+            {
+                return false;
+            }
+        }
+
+        if (!request.empty())
+        {
+            return false;
+        }
+
+        results.resize(nameCount);
+
+        if (nameCount <= ServerChunkSize)
+        {
+            DemangleNames(names, 0, nameCount, cache, results);
+        }
+        else
+        {
+            std::vector<std::future<void>> chunks;
+            std::exception_ptr exception;
+
+            try
+            {
+                for (size_t start = 0; start < nameCount; start += ServerChunkSize)
+                {
+                    const size_t end = std::min<size_t>(start + ServerChunkSize, nameCount);
+                    auto task = std::make_shared<std::packaged_task<void()>>([&, start, end]() { DemangleNames(names, start, end, cache, results); });
+
+                    chunks.push_back(task->get_future());
+                    state.threadPool.Submit([task]() { (*task)(); });
+                }
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            // The chunks refer to the names and results of this request, every chunk that was submitted
+            // must finish before the first exception is rethrown.
+            for (std::future<void>& chunk : chunks)
+            {
+                try
+                {
+                    chunk.get();
+                }
+                catch (...)
+                {
+                    if (!exception)
+                    {
+                        exception = std::current_exception();
+                    }
+                }
+            }
+
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // The demangled names can be much longer than the mangled names, e.g. when a name repeats a long
+        // template argument. The count and lengths always fit because the request had to contain them,
+        // a name that does not fit in the rest of the frame is returned as one that cannot be demangled.
+        size_t remainingSize = MaxDemangleFrameSize - (sizeof(uint32_t) + (sizeof(uint32_t) * static_cast<size_t>(nameCount)));
+
+        response.clear();
+        AppendUInt32(response, nameCount);
+
+        for (const std::string& result : results)
+        {
+            if (result.size() <= remainingSize)
+            {
+                AppendUInt32(response, static_cast<uint32_t>(result.size()));
+                response.append(result);
+                remainingSize -= result.size();
+            }
+            else
+            {
+                AppendUInt32(response, 0);
+            }
+        }
+
+        return true;
+    }
+
+    void ServeConnection(LocalSocket socket, ServerState& state)
+    {
+        SetTraceThreadName("connection");
+
+        struct ConnectionCountGuard
+        {
+            std::atomic<size_t>& connectionCount;
+
+            ~ConnectionCountGuard()
+            {
+                connectionCount--;
+            }
+        } connectionCountGuard{ state.connectionCount };
+
+        // The buffers are reused for every request on the connection.
+        std::string request;
+        std::string response;
+        std::vector<std::string_view> names;
+        std::vector<std::string> results;
+
+        try
+        {
+            while (ReadFrame(socket, request))
+            {
+                if (!ProcessRequest(request, state, names, results, response))
+                {
+                    // Close the connection, the framing cannot be trusted after a malformed request.
+                    break;
+                }
+
+                TRACE_SPAN("write response");
+                WriteFrame(socket, response);
+            }
+        }
+        catch (const std::exception&)
+        {
+            // The client disconnected or sent an invalid frame, only this connection is closed.
+        }
+    }
+}
+
+void RunDemangleServer(const std::filesystem::path& socketPath, ThreadPool& threadPool)
+{
+    LocalSocket listener = LocalSocket::Listen(socketPath);
+    ServerState state(threadPool);
+
+    std::cout << "Listening on " << socketPath.string() << ", press Ctrl+C to stop." << std::endl;
+
+    while (true)
+    {
+        LocalSocket socket = listener.Accept();
+
+        // The count is decremented by the connection thread when the connection is closed.
+        if (state.connectionCount >= MaxServerConnections)
+        {
+            // The socket is closed when it goes out of scope, the client reads the end of the stream.
+            std::cerr << "Refused a connection, " << MaxServerConnections << " connections are already open." << std::endl;
+            continue;
+        }
+
+        state.connectionCount++;
+        std::thread(ServeConnection, std::move(socket), std::ref(state)).detach();
+    }
+}
@@ -0,0 +1,30 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ThreadPool.h"
+#include <filesystem>
+
+// Listens on a Unix domain socket and answers demangle requests, see DemangleProtocol.h.
+// Every connection is served by its own thread, large batches are split over the thread pool.
+// The demangled names are shared by all of the connections through one cache per format.
+// This function does not return unless the socket cannot be created.
+void RunDemangleServer(const std::filesystem::path& socketPath, ThreadPool& threadPool);
@@ -0,0 +1,486 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleStats.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The symbol latencies use a log-linear histogram: values below 32 ns have their own bucket, larger
+// values are split into 16 buckets per power of 2, which keeps the error of a percentile below 6.25%.
+static constexpr unsigned LatencySubBucketBits = 4;
+static constexpr size_t LatencySubBucketCount = size_t(1) << LatencySubBucketBits;
+
+static constexpr size_t GetLatencyBucket(uint64_t nanoseconds) noexcept
+{
+    if (nanoseconds < 2 * LatencySubBucketCount)
+    {
+        return static_cast<size_t>(nanoseconds);
+    }
+
+    const unsigned shift = static_cast<unsigned>(std::bit_width(nanoseconds)) - 1 - LatencySubBucketBits;
+
+    return shift * LatencySubBucketCount + static_cast<size_t>(nanoseconds >> shift);
+}
+
+// Returns the largest value that is counted in the bucket.
+static constexpr uint64_t GetLatencyBucketUpperBound(size_t bucket) noexcept
+{
+    if (bucket < 2 * LatencySubBucketCount)
+    {
+        return bucket;
+    }
+
+    const unsigned shift = static_cast<unsigned>(bucket / LatencySubBucketCount) - 1;
+    const uint64_t mantissa = (bucket % LatencySubBucketCount) + LatencySubBucketCount;
+
+    return ((mantissa + 1) << shift) - 1;
+}
+
+static_assert(GetLatencyBucket(31) == 31 && GetLatencyBucket(32) == 32 && GetLatencyBucket(33) == 32 && GetLatencyBucket(34) == 33);
+static_assert(GetLatencyBucketUpperBound(GetLatencyBucket(1000)) >= 1000 && GetLatencyBucketUpperBound(GetLatencyBucket(1000) - 1) < 1000);
+static constexpr size_t LatencyBucketCount = GetLatencyBucket(UINT64_MAX) + 1;
+
+static constexpr std::array<const char*, static_cast<size_t>(DemangleStatsPhase::Count)> PhaseNames
+{
+    "readInput",
+    "preprocessLine",
+    "demangle",
+    "parameterSubstitution",
+    "writeOutput"
+};
+
+static constexpr std::array<const char*, static_cast<size_t>(DemangleStatsPhase::Count)> PhaseDescriptions
+{
+    "Read input",
+    "Strip prefixes",
+    "cplus_demangle",
+    "Parameter substitutions",
+    "Write output"
+};
+
+static constexpr std::array<const char*, static_cast<size_t>(DemangleStatsCounter::Count)> CounterNames
+{
+    "linesRead",
+    "blankLines",
+    "malformedLines",
+    "thunksStripped",
+    "virtualPrototypes",
+    "demangleFailures",
+    "substitutionHits"
+};
+
+static constexpr std::array<const char*, static_cast<size_t>(DemangleStatsCounter::Count)> CounterDescriptions
+{
+    "Lines read",
+    "Blank lines skipped",
+    "Malformed lines",
+    "Thunks stripped",
+    "Virtual prototypes parsed",
+    "Demangle failures",
+    "Substitution hits"
+};
+
+namespace
+{
+    struct SlowSymbol
+    {
+        uint64_t nanoseconds;
+        std::string mangledName;
+    };
+
+    struct DemangleStatsValues
+    {
+        std::array<uint64_t, static_cast<size_t>(DemangleStatsCounter::Count)> counters{};
+        std::array<uint64_t, static_cast<size_t>(DemangleStatsPhase::Count)> nanoseconds{};
+        std::array<uint64_t, LatencyBucketCount> latencyBuckets{};
+        uint64_t maxLatency = 0;
+        std::vector<SlowSymbol> slowestSymbols;
+    };
+
+#if SC3K_DEMANGLE_STATS
+
+    // Orders the slowest symbols as a min-heap, the fastest of them is replaced first.
+    bool IsSlowerSymbol(const SlowSymbol& a, const SlowSymbol& b) noexcept
+    {
+        return a.nanoseconds > b.nanoseconds;
+    }
+
+    // The values are only written by the owning thread, relaxed loads and stores avoid the cost of
+    // atomic read-modify-write operations while still allowing the values to be read at any time.
+    struct ThreadStats
+    {
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(DemangleStatsCounter::Count)> counters{};
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(DemangleStatsPhase::Count)> nanoseconds{};
+        std::array<std::atomic<uint64_t>, LatencyBucketCount> latencyBuckets{};
+        std::atomic<uint64_t> maxLatency{};
+        // The slowest symbols are only locked when a symbol is added or the values are read, the owning
+        // thread can check the heap without the lock because no other thread modifies it.
+        mutable std::mutex slowestSymbolsMutex;
+        std::vector<SlowSymbol> slowestSymbols;
+
+        ThreadStats();
+        ~ThreadStats();
+
+        void AddTo(DemangleStatsValues& values) const noexcept
+        {
+            for (size_t i = 0; i < counters.size(); i++)
+            {
+                values.counters[i] += counters[i].load(std::memory_order_relaxed);
+            }
+
+            for (size_t i = 0; i < nanoseconds.size(); i++)
+            {
+                values.nanoseconds[i] += nanoseconds[i].load(std::memory_order_relaxed);
+            }
+
+            for (size_t i = 0; i < latencyBuckets.size(); i++)
+            {
+                values.latencyBuckets[i] += latencyBuckets[i].load(std::memory_order_relaxed);
+            }
+
+            values.maxLatency = std::max(values.maxLatency, maxLatency.load(std::memory_order_relaxed));
+
+            std::lock_guard<std::mutex> lock(slowestSymbolsMutex);
+            values.slowestSymbols.insert(values.slowestSymbols.end(), slowestSymbols.begin(), slowestSymbols.end());
+        }
+    };
+
+    struct StatsRegistry
+    {
+        std::mutex mutex;
+        std::vector<const ThreadStats*> threads;
+        // The totals of the threads that have exited.
+        DemangleStatsValues exitedThreads;
+    };
+
+    StatsRegistry& GetRegistry()
+    {
+        // Never destroyed, the threads may exit after the static destructors have run.
+        static StatsRegistry* const registry = new StatsRegistry();
+        return *registry;
+    }
+
+    ThreadStats::ThreadStats()
+    {
+        StatsRegistry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        registry.threads.push_back(this);
+    }
+
+    ThreadStats::~ThreadStats()
+    {
+        StatsRegistry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        AddTo(registry.exitedThreads);
+        std::erase(registry.threads, this);
+    }
+
+    ThreadStats& GetThreadStats()
+    {
+        thread_local ThreadStats stats;
+        return stats;
+    }
+
+    void AddRelaxed(std::atomic<uint64_t>& value, uint64_t amount) noexcept
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+#endif
+}
+
+#if SC3K_DEMANGLE_STATS
+
+static bool statsEnabled = false;
+static size_t slowestSymbolCount = 0;
+
+void EnableDemangleStats(size_t slowestCount) noexcept
+{
+    statsEnabled = true;
+    slowestSymbolCount = slowestCount;
+}
+
+bool IsDemangleStatsEnabled() noexcept
+{
+    return statsEnabled;
+}
+
+void AddDemangleStatsCounter(DemangleStatsCounter counter, uint64_t value) noexcept
+{
+    if (statsEnabled)
+    {
+        AddRelaxed(GetThreadStats().counters[static_cast<size_t>(counter)], value);
+    }
+}
+
+void AddDemangleStatsTime(DemangleStatsPhase phase, uint64_t nanoseconds) noexcept
+{
+    if (statsEnabled)
+    {
+        AddRelaxed(GetThreadStats().nanoseconds[static_cast<size_t>(phase)], nanoseconds);
+    }
+}
+
+static int64_t GetTimestamp() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+DemangleStatsTimer::DemangleStatsTimer(DemangleStatsPhase phase) noexcept
+    : phase(phase), start(statsEnabled ? GetTimestamp() : 0)
+{
+}
+
+DemangleStatsTimer::~DemangleStatsTimer()
+{
+    if (statsEnabled)
+    {
+        AddDemangleStatsTime(phase, static_cast<uint64_t>(GetTimestamp() - start));
+    }
+}
+
+DemangleStatsSymbolTimer::DemangleStatsSymbolTimer(const char* mangledName) noexcept
+    : mangledName(mangledName), start(statsEnabled ? GetTimestamp() : 0)
+{
+}
+
+DemangleStatsSymbolTimer::~DemangleStatsSymbolTimer()
+{
+    if (!statsEnabled)
+    {
+        return;
+    }
+
+    const uint64_t nanoseconds = static_cast<uint64_t>(GetTimestamp() - start);
+    ThreadStats& stats = GetThreadStats();
+
+    AddRelaxed(stats.latencyBuckets[GetLatencyBucket(nanoseconds)], 1);
+
+    if (nanoseconds > stats.maxLatency.load(std::memory_order_relaxed))
+    {
+        stats.maxLatency.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    if (slowestSymbolCount > 0
+        && (stats.slowestSymbols.size() < slowestSymbolCount || nanoseconds > stats.slowestSymbols.front().nanoseconds))
+    {
+        std::lock_guard<std::mutex> lock(stats.slowestSymbolsMutex);
+
+        if (stats.slowestSymbols.size() == slowestSymbolCount)
+        {
+            std::pop_heap(stats.slowestSymbols.begin(), stats.slowestSymbols.end(), IsSlowerSymbol);
+            stats.slowestSymbols.pop_back();
+        }
+
+        stats.slowestSymbols.push_back(SlowSymbol{ nanoseconds, mangledName });
+        std::push_heap(stats.slowestSymbols.begin(), stats.slowestSymbols.end(), IsSlowerSymbol);
+    }
+}
+
+static DemangleStatsValues GetStatsValues()
+{
+    StatsRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    DemangleStatsValues values = registry.exitedThreads;
+
+    for (const ThreadStats* thread : registry.threads)
+    {
+        thread->AddTo(values);
+    }
+
+    std::sort(values.slowestSymbols.begin(), values.slowestSymbols.end(), IsSlowerSymbol);
+
+    if (values.slowestSymbols.size() > slowestSymbolCount)
+    {
+        values.slowestSymbols.resize(slowestSymbolCount);
+    }
+
+    return values;
+}
+
+#else
+
+static DemangleStatsValues GetStatsValues()
+{
+    throw std::runtime_error("This build does not collect statistics, it was compiled with SC3K_DEMANGLE_STATS set to 0.");
+}
+
+#endif
+
+static uint64_t GetLatencyCount(const DemangleStatsValues& values) noexcept
+{
+    uint64_t count = 0;
+
+    for (const uint64_t bucketCount : values.latencyBuckets)
+    {
+        count += bucketCount;
+    }
+
+    return count;
+}
+
+// Returns the latency that the given fraction of the symbols did not exceed.
+static uint64_t GetLatencyPercentile(const DemangleStatsValues& values, double fraction) noexcept
+{
+    const uint64_t count = GetLatencyCount(values);
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(count) * fraction + 0.5));
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < values.latencyBuckets.size(); i++)
+    {
+        seen += values.latencyBuckets[i];
+
+        if (seen >= target)
+        {
+            return std::min(GetLatencyBucketUpperBound(i), values.maxLatency);
+        }
+    }
+
+    return values.maxLatency;
+}
+
+static constexpr std::array<std::pair<const char*, double>, 3> LatencyPercentiles
+{{
+    { "p50", 0.5 },
+    { "p99", 0.99 },
+    { "p99.9", 0.999 }
+}};
+
+static void WriteJsonString(std::ostream& out, std::string_view text)
+{
+    out << '"';
+
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+            out << escape;
+        }
+        else
+        {
+            out << c;
+        }
+    }
+
+    out << '"';
+}
+
+void WriteDemangleStatsSummary(std::ostream& out)
+{
+    const DemangleStatsValues values = GetStatsValues();
+
+    out << "Phase times:" << std::endl;
+    out << std::fixed << std::setprecision(3);
+
+    for (size_t i = 0; i < values.nanoseconds.size(); i++)
+    {
+        out << "  " << std::left << std::setw(26) << PhaseDescriptions[i] << std::right
+            << std::setw(12) << (static_cast<double>(values.nanoseconds[i]) / 1e6) << " ms" << std::endl;
+    }
+
+    out << "Counters:" << std::endl;
+
+    for (size_t i = 0; i < values.counters.size(); i++)
+    {
+        out << "  " << std::left << std::setw(26) << CounterDescriptions[i] << std::right
+            << std::setw(12) << values.counters[i] << std::endl;
+    }
+
+    out << "Symbol latency (" << GetLatencyCount(values) << " symbols):" << std::endl;
+
+    for (const auto& [name, fraction] : LatencyPercentiles)
+    {
+        out << "  " << std::left << std::setw(26) << name << std::right
+            << std::setw(12) << GetLatencyPercentile(values, fraction) << " ns" << std::endl;
+    }
+
+    out << "  " << std::left << std::setw(26) << "max" << std::right << std::setw(12) << values.maxLatency << " ns" << std::endl;
+
+    if (!values.slowestSymbols.empty())
+    {
+        out << "Slowest symbols:" << std::endl;
+
+        for (const SlowSymbol& symbol : values.slowestSymbols)
+        {
+            out << "  " << std::setw(10) << symbol.nanoseconds << " ns  length " << std::setw(4) << symbol.mangledName.size()
+                << "  " << symbol.mangledName << std::endl;
+        }
+    }
+}
+
+void WriteDemangleStatsJson(std::ostream& out)
+{
+    const DemangleStatsValues values = GetStatsValues();
+
+    out << "{\n  \"phaseNanoseconds\": {";
+
+    for (size_t i = 0; i < values.nanoseconds.size(); i++)
+    {
+        out << (i > 0 ? "," : "") << "\n    \"" << PhaseNames[i] << "\": " << values.nanoseconds[i];
+    }
+
+    out << "\n  },\n  \"counters\": {";
+
+    for (size_t i = 0; i < values.counters.size(); i++)
+    {
+        out << (i > 0 ? "," : "") << "\n    \"" << CounterNames[i] << "\": " << values.counters[i];
+    }
+
+    out << "\n  },\n  \"symbolLatencyNanoseconds\": {\n    \"count\": " << GetLatencyCount(values);
+
+    for (const auto& [name, fraction] : LatencyPercentiles)
+    {
+        out << ",\n    \"" << name << "\": " << GetLatencyPercentile(values, fraction);
+    }
+
+    out << ",\n    \"max\": " << values.maxLatency << "\n  },\n  \"slowestSymbols\": [";
+
+    for (size_t i = 0; i < values.slowestSymbols.size(); i++)
+    {
+        const SlowSymbol& symbol = values.slowestSymbols[i];
+
+        out << (i > 0 ? "," : "") << "\n    { \"nanoseconds\": " << symbol.nanoseconds
+            << ", \"length\": " << symbol.mangledName.size() << ", \"mangledName\": ";
+        WriteJsonString(out, symbol.mangledName);
+        out << " }";
+    }
+
+    out << "\n  ]\n}\n";
+}
@@ -0,0 +1,117 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Phase timers and counters for the line processing pipeline, printed by the --stats option.
+// Define SC3K_DEMANGLE_STATS as 0 to remove the instrumentation from the build, the macros
+// below then expand to nothing.
+#ifndef SC3K_DEMANGLE_STATS
+#define SC3K_DEMANGLE_STATS 1
+#endif
+
+enum class DemangleStatsPhase
+{
+    ReadInput,
+    PreprocessLine,
+    Demangle,
+    ParameterSubstitution,
+    WriteOutput,
+    Count
+};
+
+enum class DemangleStatsCounter
+{
+    LinesRead,
+    BlankLines,
+    MalformedLines,
+    ThunksStripped,
+    VirtualPrototypes,
+    DemangleFailures,
+    SubstitutionHits,
+    Count
+};
+
+#if SC3K_DEMANGLE_STATS
+
+// Starts collecting the statistics, this must be called before the worker threads start.
+// The report lists the given number of symbols that took the longest to demangle.
+void EnableDemangleStats(size_t slowestSymbolCount) noexcept;
+
+bool IsDemangleStatsEnabled() noexcept;
+
+// Each thread adds to its own totals, the totals are combined when the statistics are written.
+void AddDemangleStatsCounter(DemangleStatsCounter counter, uint64_t value) noexcept;
+void AddDemangleStatsTime(DemangleStatsPhase phase, uint64_t nanoseconds) noexcept;
+
+// Adds the time from construction to destruction to the phase.
+class DemangleStatsTimer
+{
+public:
+    explicit DemangleStatsTimer(DemangleStatsPhase phase) noexcept;
+    ~DemangleStatsTimer();
+
+    DemangleStatsTimer(const DemangleStatsTimer&) = delete;
+    DemangleStatsTimer& operator=(const DemangleStatsTimer&) = delete;
+
+private:
+    DemangleStatsPhase phase;
+    int64_t start;
+};
+
+// Adds the time from construction to destruction to the symbol latency histogram, and to the
+// slowest symbols if it is one of the longest times.
+class DemangleStatsSymbolTimer
+{
+public:
+    explicit DemangleStatsSymbolTimer(const char* mangledName) noexcept;
+    ~DemangleStatsSymbolTimer();
+
+    DemangleStatsSymbolTimer(const DemangleStatsSymbolTimer&) = delete;
+    DemangleStatsSymbolTimer& operator=(const DemangleStatsSymbolTimer&) = delete;
+
+private:
+    const char* mangledName;
+    int64_t start;
+};
+
+#define DEMANGLE_STATS_CONCAT_INNER(a, b) a##b
+#define DEMANGLE_STATS_CONCAT(a, b) DEMANGLE_STATS_CONCAT_INNER(a, b)
+#define DEMANGLE_STATS_TIMER(phase) const DemangleStatsTimer DEMANGLE_STATS_CONCAT(demangleStatsTimer, __LINE__)(DemangleStatsPhase::phase)
+#define DEMANGLE_STATS_COUNT(counter) AddDemangleStatsCounter(DemangleStatsCounter::counter, 1)
+#define DEMANGLE_STATS_SYMBOL_TIMER(mangledName) const DemangleStatsSymbolTimer DEMANGLE_STATS_CONCAT(demangleStatsSymbolTimer, __LINE__)(mangledName)
+
+#else
+
+#define DEMANGLE_STATS_TIMER(phase) ((void)0)
+#define DEMANGLE_STATS_COUNT(counter) ((void)0)
+#define DEMANGLE_STATS_SYMBOL_TIMER(mangledName) ((void)0)
+
+#endif
+
+// Writes a human-readable summary of the statistics.
+void WriteDemangleStatsSummary(std::ostream& out);
+
+// Writes the statistics as a JSON object, the times are in nanoseconds.
+void WriteDemangleStatsJson(std::ostream& out);
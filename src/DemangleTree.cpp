@@ -0,0 +1,1066 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleTree.h"
+#include "DemangleUtil.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr std::array<std::string_view, 11> BuiltinTypeWords
+    {
+        "unsigned", "signed", "void", "bool", "char", "wchar_t", "short", "int", "long", "float", "double"
+    };
+
+    constexpr std::string_view OperatorPrefix = "operator";
+    constexpr std::string_view ConstSuffix = " const";
+
+    bool IsIdentifierCharacter(char c) noexcept
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' || c == '.' || c == '~';
+    }
+
+    bool StartsWithWord(std::string_view text, std::string_view word) noexcept
+    {
+        return text.starts_with(word) && (text.size() == word.size() || !IsIdentifierCharacter(text[word.size()]));
+    }
+
+    // Returns the position of the bracket that opens the bracket at the end position, or npos.
+    size_t FindOpeningBracket(std::string_view text, size_t end, char open, char close) noexcept
+    {
+        int depth = 0;
+
+        for (size_t i = end + 1; i-- > 0;)
+        {
+            if (text[i] == close)
+            {
+                depth++;
+            }
+            else if (text[i] == open && --depth == 0)
+            {
+                return i;
+            }
+        }
+
+        return std::string_view::npos;
+    }
+
+    // Returns the position of the bracket that closes the bracket at the start position, or npos.
+    size_t FindClosingBracket(std::string_view text, size_t start, char open, char close) noexcept
+    {
+        int depth = 0;
+
+        for (size_t i = start; i < text.size(); i++)
+        {
+            if (text[i] == open)
+            {
+                depth++;
+            }
+            else if (text[i] == close && --depth == 0)
+            {
+                return i;
+            }
+        }
+
+        return std::string_view::npos;
+    }
+
+    // Splits the text at the commas that are not inside brackets.
+    void SplitList(std::string_view text, std::vector<std::string_view>& items)
+    {
+        int depth = 0;
+        size_t itemStart = 0;
+
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            const char c = text[i];
+
+            if (c == '<' || c == '(' || c == '[')
+            {
+                depth++;
+            }
+            else if (c == '>' || c == ')' || c == ']')
+            {
+                depth--;
+            }
+            else if (c == ',' && depth == 0)
+            {
+                items.push_back(text.substr(itemStart, i - itemStart));
+                itemStart = i + 1;
+            }
+        }
+
+        items.push_back(text.substr(itemStart));
+    }
+
+    bool EndsWithConstSuffix(std::string_view text) noexcept
+    {
+        return text.size() > ConstSuffix.size() + 1 && text.ends_with(ConstSuffix) && text[text.size() - ConstSuffix.size() - 1] == ')';
+    }
+
+    void AppendQualifiers(std::string& result, DemangleCvQualifiers qualifiers)
+    {
+        switch (qualifiers)
+        {
+        case DemangleCvQualifiers::Const:
+            result += "const";
+            break;
+        case DemangleCvQualifiers::Volatile:
+            result += "volatile";
+            break;
+        case DemangleCvQualifiers::ConstVolatile:
+            result += "const volatile";
+            break;
+        case DemangleCvQualifiers::VolatileConst:
+            result += "volatile const";
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Adds a const or volatile word to the qualifiers, returns false if the word is repeated.
+    bool AddQualifier(DemangleCvQualifiers& qualifiers, bool isConst) noexcept
+    {
+        switch (qualifiers)
+        {
+        case DemangleCvQualifiers::None:
+            qualifiers = isConst ? DemangleCvQualifiers::Const : DemangleCvQualifiers::Volatile;
+            return true;
+        case DemangleCvQualifiers::Const:
+            qualifiers = DemangleCvQualifiers::ConstVolatile;
+            return !isConst;
+        case DemangleCvQualifiers::Volatile:
+            qualifiers = DemangleCvQualifiers::VolatileConst;
+            return isConst;
+        default:
+            return false;
+        }
+    }
+
+    // Consumes the const and volatile words at the start of the text, each word is preceded by a separator
+    // if requireSeparator is set.
+    DemangleCvQualifiers ConsumeQualifiers(std::string_view& text, bool requireSeparator)
+    {
+        DemangleCvQualifiers qualifiers = DemangleCvQualifiers::None;
+
+        for (;;)
+        {
+            std::string_view rest = text;
+
+            if (requireSeparator || qualifiers != DemangleCvQualifiers::None)
+            {
+                if (!rest.starts_with(' '))
+                {
+                    break;
+                }
+                rest.remove_prefix(1);
+            }
+
+            const bool isConst = StartsWithWord(rest, "const");
+
+            if (!isConst && !StartsWithWord(rest, "volatile"))
+            {
+                break;
+            }
+
+            if (!AddQualifier(qualifiers, isConst))
+            {
+                break;
+            }
+
+            rest.remove_prefix(isConst ? 5 : 8);
+            text = rest;
+        }
+
+        return qualifiers;
+    }
+
+    void RenderType(const DemangleType& type, std::string& result);
+
+    void RenderNamePart(const DemangleNamePart& part, std::string& result)
+    {
+        result += part.identifier;
+
+        if (!part.isTemplate)
+        {
+            return;
+        }
+
+        result += '<';
+
+        for (size_t i = 0; i < part.templateArguments.size(); i++)
+        {
+            const DemangleTemplateArgument& argument = part.templateArguments[i];
+
+            if (i > 0)
+            {
+                result += ", ";
+            }
+
+            if (argument.type)
+            {
+                RenderType(*argument.type, result);
+            }
+            else
+            {
+                result += argument.value;
+            }
+        }
+
+        // The demangler separates nested closing brackets, e.g. cArray<cArray<int> >.
+        if (result.back() == '>')
+        {
+            result += ' ';
+        }
+
+        result += '>';
+    }
+
+    void RenderQualifiedName(std::span<const DemangleNamePart> parts, std::string& result)
+    {
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            if (i > 0)
+            {
+                result += "::";
+            }
+
+            RenderNamePart(parts[i], result);
+        }
+    }
+
+    void RenderParameters(std::span<const DemangleType> parameters, bool isConstFunction, std::string& result)
+    {
+        result += '(';
+
+        if (parameters.empty())
+        {
+            result += "void";
+        }
+
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            if (i > 0)
+            {
+                // The demangler does not put a space in front of the ... of a variadic function.
+                result += parameters[i].kind == DemangleTypeKind::Ellipsis ? "," : ", ";
+            }
+
+            RenderType(parameters[i], result);
+        }
+
+        result += ')';
+
+        if (isConstFunction)
+        {
+            result += ConstSuffix;
+        }
+    }
+
+    void RenderType(const DemangleType& type, std::string& result)
+    {
+        switch (type.kind)
+        {
+        case DemangleTypeKind::Builtin:
+        case DemangleTypeKind::Named:
+            RenderQualifiedName(type.name, result);
+            break;
+        case DemangleTypeKind::FunctionPointer:
+            if (type.returnType)
+            {
+                RenderType(*type.returnType, result);
+                result += ' ';
+            }
+            result += '(';
+            result += type.declarator;
+            result += ')';
+            RenderParameters(type.parameters, type.isConstFunction, result);
+            return;
+        case DemangleTypeKind::Ellipsis:
+            result += "...";
+            return;
+        default:
+            result += type.text;
+            return;
+        }
+
+        if (type.qualifiers != DemangleCvQualifiers::None)
+        {
+            result += ' ';
+            AppendQualifiers(result, type.qualifiers);
+        }
+
+        // The demangler separates the modifiers from the type, e.g. char const *.
+        if (!type.modifiers.empty())
+        {
+            result += ' ';
+        }
+
+        for (size_t i = 0; i < type.modifiers.size(); i++)
+        {
+            const DemangleTypeModifier& modifier = type.modifiers[i];
+
+            result += modifier.kind == DemangleTypeModifierKind::Pointer ? '*' : '&';
+
+            if (modifier.qualifiers != DemangleCvQualifiers::None)
+            {
+                AppendQualifiers(result, modifier.qualifiers);
+
+                if (i + 1 < type.modifiers.size())
+                {
+                    result += ' ';
+                }
+            }
+        }
+    }
+
+    class TreeParser
+    {
+    public:
+        explicit TreeParser(std::pmr::memory_resource& arena) : arena(arena)
+        {
+        }
+
+        const DemangleTree& Parse(std::string_view demangledName, size_t scopeLength)
+        {
+            char* const textData = static_cast<char*>(arena.allocate(demangledName.size(), alignof(char)));
+            std::memcpy(textData, demangledName.data(), demangledName.size());
+
+            const std::string_view text(textData, demangledName.size());
+            DemangleTree* const tree = Allocate<DemangleTree>();
+
+            *tree = DemangleTree{ DemangleTreeKind::Text, {}, {}, {}, false, text };
+
+            DemangleTree parsed = *tree;
+
+            if (ParseFunctionOrVariable(text, scopeLength, parsed))
+            {
+                // Anything that the tree does not reproduce exactly is kept as text.
+                std::string rendered;
+                RenderDemangleTree(parsed, rendered);
+
+                if (rendered == text)
+                {
+                    *tree = parsed;
+                }
+            }
+
+            return *tree;
+        }
+
+    private:
+        template <typename T>
+        T* Allocate(size_t count = 1)
+        {
+            return static_cast<T*>(arena.allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        template <typename T>
+        std::span<const T> CopyToArena(const std::vector<T>& items)
+        {
+            if (items.empty())
+            {
+                return std::span<const T>();
+            }
+
+            T* const data = Allocate<T>(items.size());
+            std::uninitialized_copy(items.begin(), items.end(), data);
+
+            return std::span<const T>(data, items.size());
+        }
+
+        bool ParseFunctionOrVariable(std::string_view text, size_t scopeLength, DemangleTree& tree)
+        {
+            const bool isConstFunction = EndsWithConstSuffix(text);
+            const std::string_view signature = isConstFunction ? text.substr(0, text.size() - ConstSuffix.size()) : text;
+
+            if (signature.ends_with(')'))
+            {
+                const size_t parametersStart = FindOpeningBracket(signature, signature.size() - 1, '(', ')');
+
+                if (parametersStart == std::string_view::npos || parametersStart == 0
+                    || !ParseScopedName(signature.substr(0, parametersStart), scopeLength, tree)
+                    || !ParseParameters(signature.substr(parametersStart + 1, signature.size() - parametersStart - 2), tree.parameters))
+                {
+                    return false;
+                }
+
+                tree.kind = DemangleTreeKind::Function;
+                tree.isConstFunction = isConstFunction;
+            }
+            else if (ParseScopedName(text, scopeLength, tree))
+            {
+                tree.kind = DemangleTreeKind::Variable;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        // Splits the name at the end of the scope that the demangler recorded, so a :: in a template argument
+        // of the scope, e.g. cRZMap<cSC3Zone::Type>::Get, is never taken for the separator.
+        bool ParseScopedName(std::string_view text, size_t scopeLength, DemangleTree& tree)
+        {
+            std::vector<DemangleNamePart> parts;
+            std::string_view name = text;
+
+            if (scopeLength != std::string_view::npos)
+            {
+                if (scopeLength == 0 || text.size() < scopeLength + 2 || text.substr(scopeLength, 2) != "::"
+                    || !ParseQualifiedName(text.substr(0, scopeLength), parts))
+                {
+                    return false;
+                }
+
+                name = text.substr(scopeLength + 2);
+            }
+
+            tree.scope = CopyToArena(parts);
+            parts.clear();
+
+            if (!ParseQualifiedName(name, parts) || parts.size() != 1)
+            {
+                return false;
+            }
+
+            tree.name = parts[0];
+            return true;
+        }
+
+        bool ParseParameters(std::string_view text, std::span<const DemangleType>& parameters)
+        {
+            if (text == "void")
+            {
+                parameters = std::span<const DemangleType>();
+                return true;
+            }
+
+            std::vector<std::string_view> items;
+            std::vector<DemangleType> types;
+
+            SplitList(text, items);
+            types.reserve(items.size());
+
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                std::string_view item = items[i];
+
+                // The separator is ", ", except in front of the ... of a variadic function.
+                if (i > 0 && item != "...")
+                {
+                    if (!item.starts_with(' '))
+                    {
+                        return false;
+                    }
+                    item.remove_prefix(1);
+                }
+
+                if (item.empty())
+                {
+                    return false;
+                }
+
+                types.push_back(ParseCheckedType(item));
+            }
+
+            parameters = CopyToArena(types);
+            return true;
+        }
+
+        // Parses the type, a type that the tree does not reproduce exactly becomes a text node.
+        DemangleType ParseCheckedType(std::string_view text)
+        {
+            DemangleType type{};
+
+            if (ParseType(text, type))
+            {
+                std::string rendered;
+                RenderType(type, rendered);
+
+                if (rendered == text)
+                {
+                    return type;
+                }
+            }
+
+            type = DemangleType{};
+            type.kind = DemangleTypeKind::Text;
+            type.text = text;
+
+            return type;
+        }
+
+        bool ParseType(std::string_view text, DemangleType& type)
+        {
+            if (text == "...")
+            {
+                type.kind = DemangleTypeKind::Ellipsis;
+                return true;
+            }
+
+            const bool isConstFunction = EndsWithConstSuffix(text);
+            const std::string_view signature = isConstFunction ? text.substr(0, text.size() - ConstSuffix.size()) : text;
+
+            if (signature.ends_with(')'))
+            {
+                return ParseFunctionPointer(signature, isConstFunction, type);
+            }
+
+            std::vector<DemangleNamePart> parts;
+            std::string_view rest;
+
+            if (!ParseTypeName(text, parts, type.kind, rest))
+            {
+                return false;
+            }
+
+            type.name = CopyToArena(parts);
+            type.qualifiers = ConsumeQualifiers(rest, true);
+
+            if (rest.empty())
+            {
+                return true;
+            }
+
+            if (!rest.starts_with(' '))
+            {
+                return false;
+            }
+
+            rest.remove_prefix(1);
+
+            std::vector<DemangleTypeModifier> modifiers;
+
+            while (!rest.empty())
+            {
+                if (!modifiers.empty() && modifiers.back().qualifiers != DemangleCvQualifiers::None)
+                {
+                    if (!rest.starts_with(' '))
+                    {
+                        return false;
+                    }
+                    rest.remove_prefix(1);
+                }
+
+                if (rest[0] != '*' && rest[0] != '&')
+                {
+                    return false;
+                }
+
+                const DemangleTypeModifierKind kind = rest[0] == '*' ? DemangleTypeModifierKind::Pointer : DemangleTypeModifierKind::Reference;
+
+                rest.remove_prefix(1);
+                modifiers.push_back(DemangleTypeModifier{ kind, ConsumeQualifiers(rest, false) });
+            }
+
+            type.modifiers = CopyToArena(modifiers);
+            return true;
+        }
+
+        // Parses a type such as void (*)(int) or int (cRZString::*)(char) const.
+        bool ParseFunctionPointer(std::string_view signature, bool isConstFunction, DemangleType& type)
+        {
+            const size_t parametersStart = FindOpeningBracket(signature, signature.size() - 1, '(', ')');
+
+            if (parametersStart == std::string_view::npos || parametersStart == 0 || signature[parametersStart - 1] != ')')
+            {
+                return false;
+            }
+
+            const size_t declaratorStart = FindOpeningBracket(signature, parametersStart - 1, '(', ')');
+
+            if (declaratorStart == std::string_view::npos)
+            {
+                return false;
+            }
+
+            if (declaratorStart > 0)
+            {
+                if (declaratorStart < 2 || signature[declaratorStart - 1] != ' ')
+                {
+                    return false;
+                }
+
+                DemangleType* const returnType = Allocate<DemangleType>();
+                *returnType = ParseCheckedType(signature.substr(0, declaratorStart - 1));
+                type.returnType = returnType;
+            }
+
+            type.kind = DemangleTypeKind::FunctionPointer;
+            type.declarator = signature.substr(declaratorStart + 1, parametersStart - declaratorStart - 2);
+            type.isConstFunction = isConstFunction;
+
+            return ParseParameters(signature.substr(parametersStart + 1, signature.size() - parametersStart - 2), type.parameters);
+        }
+
+        // Parses the fundamental or named type at the start of the text, the rest of the text is returned.
+        bool ParseTypeName(std::string_view text, std::vector<DemangleNamePart>& parts, DemangleTypeKind& kind, std::string_view& rest)
+        {
+            size_t builtinEnd = 0;
+
+            for (;;)
+            {
+                const std::string_view word = text.substr(builtinEnd == 0 ? 0 : builtinEnd + 1);
+                const auto match = std::find_if(BuiltinTypeWords.begin(), BuiltinTypeWords.end(),
+                    [word](std::string_view builtinWord) { return StartsWithWord(word, builtinWord); });
+
+                if (match == BuiltinTypeWords.end() || (builtinEnd != 0 && text[builtinEnd] != ' '))
+                {
+                    break;
+                }
+
+                builtinEnd = (builtinEnd == 0 ? 0 : builtinEnd + 1) + match->size();
+
+                if (builtinEnd == text.size())
+                {
+                    break;
+                }
+            }
+
+            if (builtinEnd != 0)
+            {
+                parts.push_back(DemangleNamePart{ text.substr(0, builtinEnd), {}, false });
+                kind = DemangleTypeKind::Builtin;
+                rest = text.substr(builtinEnd);
+                return true;
+            }
+
+            // The name ends at the first space that is not inside a template argument list.
+            int depth = 0;
+            size_t nameEnd = 0;
+
+            for (; nameEnd < text.size(); nameEnd++)
+            {
+                const char c = text[nameEnd];
+
+                if (c == '<' || c == '(')
+                {
+                    depth++;
+                }
+                else if (c == '>' || c == ')')
+                {
+                    depth--;
+                }
+                else if (c == ' ' && depth == 0)
+                {
+                    break;
+                }
+            }
+
+            kind = DemangleTypeKind::Named;
+            rest = text.substr(nameEnd);
+
+            return ParseQualifiedName(text.substr(0, nameEnd), parts);
+        }
+
+        bool ParseQualifiedName(std::string_view text, std::vector<DemangleNamePart>& parts)
+        {
+            size_t position = 0;
+
+            while (position < text.size())
+            {
+                const std::string_view rest = text.substr(position);
+
+                // An operator name is always the last part, e.g. cRZString::operator<<, and may contain
+                // spaces, e.g. cRZString::operator char const *.
+                if (rest.starts_with(OperatorPrefix) && (rest.size() == OperatorPrefix.size() || !IsIdentifierCharacter(rest[OperatorPrefix.size()])))
+                {
+                    parts.push_back(DemangleNamePart{ rest, {}, false });
+                    return true;
+                }
+
+                size_t identifierEnd = position;
+
+                while (identifierEnd < text.size() && IsIdentifierCharacter(text[identifierEnd]))
+                {
+                    identifierEnd++;
+                }
+
+                if (identifierEnd == position)
+                {
+                    return false;
+                }
+
+                DemangleNamePart part{ text.substr(position, identifierEnd - position), {}, false };
+
+                position = identifierEnd;
+
+                if (position < text.size() && text[position] == '<')
+                {
+                    const size_t argumentsEnd = FindClosingBracket(text, position, '<', '>');
+
+                    if (argumentsEnd == std::string_view::npos
+                        || !ParseTemplateArguments(text.substr(position + 1, argumentsEnd - position - 1), part.templateArguments))
+                    {
+                        return false;
+                    }
+
+                    part.isTemplate = true;
+                    position = argumentsEnd + 1;
+                }
+
+                parts.push_back(part);
+
+                if (position == text.size())
+                {
+                    return true;
+                }
+
+                if (text.substr(position, 2) != "::")
+                {
+                    return false;
+                }
+
+                position += 2;
+            }
+
+            return false;
+        }
+
+        bool ParseTemplateArguments(std::string_view text, std::span<const DemangleTemplateArgument>& arguments)
+        {
+            if (text.empty())
+            {
+                return true;
+            }
+
+            // The demangler separates nested closing brackets, e.g. cArray<cArray<int> >.
+            if (text.ends_with("> "))
+            {
+                text.remove_suffix(1);
+            }
+
+            std::vector<std::string_view> items;
+            std::vector<DemangleTemplateArgument> parsed;
+
+            SplitList(text, items);
+            parsed.reserve(items.size());
+
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                std::string_view item = items[i];
+
+                if (i > 0)
+                {
+                    if (!item.starts_with(' '))
+                    {
+                        return false;
+                    }
+                    item.remove_prefix(1);
+                }
+
+                if (item.empty())
+                {
+                    return false;
+                }
+
+                DemangleTemplateArgument argument{ nullptr, item };
+                const char first = item[0];
+
+                // Numbers, characters, addresses and boolean values are value arguments, anything else is a type.
+                if (!((first >= '0' && first <= '9') || first == '-' || first == '\'' || first == '&' || item == "true" || item == "false"))
+                {
+                    DemangleType* const type = Allocate<DemangleType>();
+                    *type = ParseCheckedType(item);
+
+                    if (type->kind != DemangleTypeKind::Text)
+                    {
+                        argument.type = type;
+                    }
+                }
+
+                parsed.push_back(argument);
+            }
+
+            arguments = CopyToArena(parsed);
+            return true;
+        }
+
+        std::pmr::memory_resource& arena;
+    };
+
+    void WriteJsonString(std::ostream& out, std::string_view text)
+    {
+        out << '"';
+
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                out << escape;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+
+        out << '"';
+    }
+
+    void WriteTypeJson(std::ostream& out, const DemangleType& type);
+
+    void WriteNamePartJson(std::ostream& out, const DemangleNamePart& part)
+    {
+        out << "{\"identifier\":";
+        WriteJsonString(out, part.identifier);
+
+        if (part.isTemplate)
+        {
+            out << ",\"templateArguments\":[";
+
+            for (size_t i = 0; i < part.templateArguments.size(); i++)
+            {
+                const DemangleTemplateArgument& argument = part.templateArguments[i];
+
+                out << (i > 0 ? "," : "");
+
+                if (argument.type)
+                {
+                    WriteTypeJson(out, *argument.type);
+                }
+                else
+                {
+                    out << "{\"value\":";
+                    WriteJsonString(out, argument.value);
+                    out << '}';
+                }
+            }
+
+            out << ']';
+        }
+
+        out << '}';
+    }
+
+    void WriteNamePartsJson(std::ostream& out, std::span<const DemangleNamePart> parts)
+    {
+        out << '[';
+
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            out << (i > 0 ? "," : "");
+            WriteNamePartJson(out, parts[i]);
+        }
+
+        out << ']';
+    }
+
+    void WriteQualifiersJson(std::ostream& out, DemangleCvQualifiers qualifiers)
+    {
+        std::string text;
+
+        AppendQualifiers(text, qualifiers);
+        WriteJsonString(out, text);
+    }
+
+    void WriteParametersJson(std::ostream& out, std::span<const DemangleType> parameters)
+    {
+        out << '[';
+
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            out << (i > 0 ? "," : "");
+            WriteTypeJson(out, parameters[i]);
+        }
+
+        out << ']';
+    }
+
+    void WriteTypeJson(std::ostream& out, const DemangleType& type)
+    {
+        switch (type.kind)
+        {
+        case DemangleTypeKind::Builtin:
+        case DemangleTypeKind::Named:
+            out << "{\"kind\":" << (type.kind == DemangleTypeKind::Builtin ? "\"builtin\"" : "\"named\"") << ",\"name\":";
+            WriteNamePartsJson(out, type.name);
+            out << ",\"qualifiers\":";
+            WriteQualifiersJson(out, type.qualifiers);
+            out << ",\"modifiers\":[";
+
+            for (size_t i = 0; i < type.modifiers.size(); i++)
+            {
+                out << (i > 0 ? "," : "") << "{\"kind\":" << (type.modifiers[i].kind == DemangleTypeModifierKind::Pointer ? "\"pointer\"" : "\"reference\"")
+                    << ",\"qualifiers\":";
+                WriteQualifiersJson(out, type.modifiers[i].qualifiers);
+                out << '}';
+            }
+
+            out << "]}";
+            break;
+        case DemangleTypeKind::FunctionPointer:
+            out << "{\"kind\":\"functionPointer\",\"returnType\":";
+
+            if (type.returnType)
+            {
+                WriteTypeJson(out, *type.returnType);
+            }
+            else
+            {
+                out << "null";
+            }
+
+            out << ",\"declarator\":";
+            WriteJsonString(out, type.declarator);
+            out << ",\"parameters\":";
+            WriteParametersJson(out, type.parameters);
+            out << ",\"const\":" << (type.isConstFunction ? "true" : "false") << '}';
+            break;
+        case DemangleTypeKind::Ellipsis:
+            out << "{\"kind\":\"ellipsis\"}";
+            break;
+        default:
+            out << "{\"kind\":\"text\",\"text\":";
+            WriteJsonString(out, type.text);
+            out << '}';
+            break;
+        }
+    }
+}
+
+const DemangleTree* BuildDemangleTree(const char* mangledName, std::pmr::memory_resource& arena)
+{
+    std::string demangled;
+    size_t scopeLength = 0;
+
+    if (!TryDemangleWithScope(mangledName, demangled, scopeLength))
+    {
+        return nullptr;
+    }
+
+    return &ParseDemangledName(demangled, scopeLength, arena);
+}
+
+const DemangleTree& ParseDemangledName(std::string_view demangledName, size_t scopeLength, std::pmr::memory_resource& arena)
+{
+    TreeParser parser(arena);
+
+    return parser.Parse(demangledName, scopeLength);
+}
+
+void RenderDemangleTree(const DemangleTree& tree, std::string& result)
+{
+    if (tree.kind == DemangleTreeKind::Text)
+    {
+        result += tree.text;
+        return;
+    }
+
+    RenderQualifiedName(tree.scope, result);
+
+    if (!tree.scope.empty())
+    {
+        result += "::";
+    }
+
+    RenderNamePart(tree.name, result);
+
+    if (tree.kind == DemangleTreeKind::Function)
+    {
+        RenderParameters(tree.parameters, tree.isConstFunction, result);
+    }
+}
+
+size_t FindDemangleTreeScopeEnd(const DemangleTree& tree, std::string_view text) noexcept
+{
+    if (tree.kind == DemangleTreeKind::Text || tree.scope.empty())
+    {
+        return std::string_view::npos;
+    }
+
+    // The name of the tree points into its text, right after the scope that the demangler recorded.
+    if (text == tree.text)
+    {
+        return static_cast<size_t>(tree.name.identifier.data() - tree.text.data()) - 2;
+    }
+
+    // The parameter type substitutions do not add or remove separators or template brackets, the separators
+    // inside the template arguments of a scope part are skipped, e.g. cRZMap<cSC3Zone::Type>::Get.
+    size_t separatorCount = 0;
+    size_t depth = 0;
+
+    for (size_t i = 0; i + 1 < text.size(); i++)
+    {
+        if (text[i] == '<')
+        {
+            depth++;
+        }
+        else if (text[i] == '>' && depth > 0)
+        {
+            depth--;
+        }
+        else if (depth == 0 && text[i] == ':' && text[i + 1] == ':')
+        {
+            if (++separatorCount == tree.scope.size())
+            {
+                return i;
+            }
+
+            i++;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+void WriteDemangleTreeJson(std::ostream& out, std::string_view mangledName, const DemangleTree& tree)
+{
+    static constexpr std::array<const char*, 3> KindNames{ "function", "variable", "text" };
+
+    out << "{\"mangled\":";
+    WriteJsonString(out, mangledName);
+    out << ",\"kind\":\"" << KindNames[static_cast<size_t>(tree.kind)] << '"';
+
+    if (tree.kind != DemangleTreeKind::Text)
+    {
+        out << ",\"scope\":";
+        WriteNamePartsJson(out, tree.scope);
+        out << ",\"name\":";
+        WriteNamePartJson(out, tree.name);
+    }
+
+    if (tree.kind == DemangleTreeKind::Function)
+    {
+        out << ",\"parameters\":";
+        WriteParametersJson(out, tree.parameters);
+        out << ",\"const\":" << (tree.isConstFunction ? "true" : "false");
+    }
+
+    out << ",\"text\":";
+    WriteJsonString(out, tree.text);
+    out << "}\n";
+}
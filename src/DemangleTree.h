@@ -0,0 +1,156 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+// A demangled name as a tree of typed nodes, so that consumers do not have to split the demangled text again.
+// The nodes and the strings they refer to are allocated in an arena, e.g. the arena of a Demangler, and remain
+// valid until the arena is released.
+//
+// The demangler records where the scope of the name ends while it demangles, the tree splits the scope from the
+// name there. The name, template arguments and parameter types are then read from the demangler output, a part
+// that the tree does not break down, e.g. an array type, is kept as a text node, so RenderDemangleTree always
+// reproduces the demangler output exactly.
+
+// The cv-qualifiers in the order the demangler writes them.
+enum class DemangleCvQualifiers : uint8_t
+{
+    None,
+    Const,
+    Volatile,
+    ConstVolatile,
+    VolatileConst
+};
+
+struct DemangleType;
+
+struct DemangleTemplateArgument
+{
+    // Null for a value argument, e.g. the 3 in cArray<3>.
+    const DemangleType* type;
+    // The text of a value argument.
+    std::string_view value;
+};
+
+// One part of a qualified name, e.g. cSC3Array<int, 3> in cSC3Array<int, 3>::Get.
+struct DemangleNamePart
+{
+    // The identifier, e.g. cSC3Array, ~cRZString or operator==.
+    std::string_view identifier;
+    std::span<const DemangleTemplateArgument> templateArguments;
+    bool isTemplate;
+};
+
+enum class DemangleTypeModifierKind : uint8_t
+{
+    Pointer,
+    Reference
+};
+
+struct DemangleTypeModifier
+{
+    DemangleTypeModifierKind kind;
+    // The qualifiers of the pointer itself, e.g. the const in char *const.
+    DemangleCvQualifiers qualifiers;
+};
+
+enum class DemangleTypeKind : uint8_t
+{
+    // A fundamental type, e.g. int or unsigned char, the name has one part.
+    Builtin,
+    // A class, struct or enum type, possibly qualified or a template instance.
+    Named,
+    // A pointer or reference to a function or member function, e.g. void (cRZString::*)(int) const.
+    FunctionPointer,
+    // The ... of a variadic function.
+    Ellipsis,
+    // A type that the tree does not break down, e.g. an array, only the text is set.
+    Text
+};
+
+struct DemangleType
+{
+    DemangleTypeKind kind;
+    // The qualifiers of the named type, e.g. the const in cRZString const &.
+    DemangleCvQualifiers qualifiers;
+    // The Builtin or Named type.
+    std::span<const DemangleNamePart> name;
+    // The pointer and reference modifiers from left to right, e.g. char const *const * has two pointers.
+    std::span<const DemangleTypeModifier> modifiers;
+    // The FunctionPointer return type, declarator (e.g. * or cRZString::*), parameters and const qualifier.
+    const DemangleType* returnType;
+    std::string_view declarator;
+    std::span<const DemangleType> parameters;
+    bool isConstFunction;
+    // The Text type.
+    std::string_view text;
+};
+
+enum class DemangleTreeKind : uint8_t
+{
+    // A function or method, e.g. cRZString::Append(char const *, unsigned int).
+    Function,
+    // A static data member or a global variable, e.g. cRZString::kEmpty.
+    Variable,
+    // Any other name, e.g. a virtual table or a thunk, only the text is set.
+    Text
+};
+
+struct DemangleTree
+{
+    DemangleTreeKind kind;
+    // The class and namespace parts of a qualified name, empty for a free function.
+    std::span<const DemangleNamePart> scope;
+    // The function or variable name.
+    DemangleNamePart name;
+    // Empty for a function that takes no parameters, the demangler writes (void).
+    std::span<const DemangleType> parameters;
+    // A const member function.
+    bool isConstFunction;
+    // The complete demangled name.
+    std::string_view text;
+};
+
+// Demangles the name and builds its tree in the arena, returns nullptr if the name cannot be demangled.
+// Uses TryDemangleWithScope, so the results come from the persistent cache when it is enabled.
+const DemangleTree* BuildDemangleTree(const char* mangledName, std::pmr::memory_resource& arena);
+
+// Builds the tree of a name in the Classic format, the text is copied to the arena.
+// The scope length is the one that TryDemangleWithScope returned for the name.
+const DemangleTree& ParseDemangledName(std::string_view demangledName, size_t scopeLength, std::pmr::memory_resource& arena);
+
+// Appends the name in the Classic format to the result.
+void RenderDemangleTree(const DemangleTree& tree, std::string& result);
+
+// Returns the position of the :: that separates the scope of a function or variable from its name in the text,
+// e.g. 9 for cRZSample::Foo(int32_t), or std::string_view::npos if the tree does not have a scope.
+// The text can be the demangler output of the tree in either DemangleFormat, the parameter type substitutions
+// do not change the scope separators.
+size_t FindDemangleTreeScopeEnd(const DemangleTree& tree, std::string_view text) noexcept;
+
+// Writes the tree and its text as a single line JSON object, e.g. for indexing scripts.
+void WriteDemangleTreeJson(std::ostream& out, std::string_view mangledName, const DemangleTree& tree);
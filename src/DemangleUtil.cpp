@@ -0,0 +1,285 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DemangleUtil.h"
+#include "DemangleStats.h"
+#include "PersistentDemangleCache.h"
+#include <charconv>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+extern "C"
+{
+#include "demangle.h"
+}
+
+static const std::vector<std::pair<std::string, std::string>> ParameterSubstitutions
+{
+    // The demangler puts a space in front of a pointer or reference modifier.
+    std::pair<std::string, std::string>(" &", "&"),
+    std::pair<std::string, std::string>(" *", "*"),
+    std::pair<std::string, std::string>(" **", "**"),
+    // All unsigned values come first so that they are correctly handled.
+    std::pair<std::string, std::string>("unsigned char", "uint8_t"),
+    std::pair<std::string, std::string>("unsigned short", "uint16_t"),
+    std::pair<std::string, std::string>("unsigned int", "uint32_t"),
+    std::pair<std::string, std::string>("unsigned long", "uint32_t"),
+    std::pair<std::string, std::string>("unsigned long long", "uint64_t"),
+    std::pair<std::string, std::string>("char", "int8_t"),
+    std::pair<std::string, std::string>("short", "int16_t"),
+    std::pair<std::string, std::string>("int", "int32_t"),
+    std::pair<std::string, std::string>("long", "int32_t"),
+    std::pair<std::string, std::string>("long long", "int64_t"),
+};
+
+class DemanglerString
+{
+public:
+    DemanglerString(char* ptr) : ptr(ptr)
+    {
+    }
+
+    ~DemanglerString()
+    {
+        char* localPtr = ptr;
+        ptr = nullptr;
+
+        if (localPtr)
+        {
+            free(localPtr);
+        }
+    }
+
+    const char* const Get() const noexcept
+    {
+        return ptr;
+    }
+
+private:
+    char* ptr;
+};
+
+// Adapted from https://stackoverflow.com/a/24315631
+static inline void DoFunctionParameterSubstitution(std::string& str, const std::string& from, const std::string& to)
+{
+    size_t start_pos = 0;
+    while ((start_pos = str.find(from, start_pos)) != std::string::npos) {
+
+        if (start_pos > 0)
+        {
+            // Check that the term we are replacing is a whole word, this prevents a double replacement.
+            // For example, uint32_t being converted to uint32_t32_t
+
+            char previous = str[start_pos - 1];
+            char next = str[start_pos + from.length() + 1];
+
+            // The first character in 'from' is checked for the replacement strings that
+            // strip a leading space from the &, * and ** operators.
+            if ((previous == ' ' || previous == '(' || from[0] == ' ')
+                && (next == ',' || next == ')' || next == ' ' || next == '\0'))
+            {
+                str.replace(start_pos, from.length(), to);
+                DEMANGLE_STATS_COUNT(SubstitutionHits);
+            }
+        }
+
+        start_pos += to.length(); // Handles case where 'to' is a substring of 'from'
+    }
+}
+
+void ConvertToFixedWidthTypes(std::string& demangledName)
+{
+    for (const auto& item : ParameterSubstitutions)
+    {
+        DoFunctionParameterSubstitution(demangledName, item.first, item.second);
+    }
+}
+
+static PersistentDemangleCache* persistentCache = nullptr;
+
+// Marks the cache entries of TryDemangleWithScope, their values also have the scope length.
+static constexpr uint32_t CacheScopeOption = 1 << 15;
+
+// Identifies the demangler configuration in the persistent cache entries.
+static constexpr uint32_t GetCacheOptions(DemangleFormat format, bool withScope) noexcept
+{
+    return (ParameterSubstitutionsVersion << 24) | (static_cast<uint32_t>(format) << 16) | (withScope ? CacheScopeOption : 0) | (DMGL_PARAMS | DMGL_ANSI);
+}
+
+// The scope length follows the demangled name after a null character, a demangled name never contains one.
+static void SplitCachedScope(std::string_view cachedValue, std::string& result, size_t& scopeLength)
+{
+    const size_t separator = cachedValue.find('\0');
+
+    result.assign(cachedValue.substr(0, separator));
+    scopeLength = std::string::npos;
+
+    if (separator != std::string_view::npos)
+    {
+        const std::string_view digits = cachedValue.substr(separator + 1);
+        size_t value = 0;
+
+        if (std::from_chars(digits.data(), digits.data() + digits.size(), value).ec == std::errc() && value < result.size())
+        {
+            scopeLength = value;
+        }
+    }
+}
+
+void SetPersistentDemangleCache(PersistentDemangleCache* cache) noexcept
+{
+    persistentCache = cache;
+}
+
+// Demangles the name through the persistent cache, the scope length is only returned if it is not null.
+static bool DemangleName(const char* const mangledName, DemangleFormat format, std::string& result, size_t* scopeLength)
+{
+    // Every mode demangles through this function, the latency includes the persistent cache lookup.
+    DEMANGLE_STATS_SYMBOL_TIMER(mangledName);
+
+    PersistentDemangleCache* const cache = persistentCache;
+    const uint32_t cacheOptions = GetCacheOptions(format, scopeLength != nullptr);
+
+    if (cache)
+    {
+        std::string_view cachedValue;
+        bool isDemangled = false;
+
+        if (cache->TryGet(mangledName, cacheOptions, cachedValue, isDemangled))
+        {
+            if (isDemangled)
+            {
+                if (scopeLength)
+                {
+                    SplitCachedScope(cachedValue, result, *scopeLength);
+                }
+                else
+                {
+                    result.assign(cachedValue);
+                }
+            }
+            else
+            {
+                DEMANGLE_STATS_COUNT(DemangleFailures);
+            }
+
+            return isDemangled;
+        }
+    }
+
+    char* demangledName;
+    int demangledScopeLength;
+
+    {
+        DEMANGLE_STATS_TIMER(Demangle);
+        demangledName = cplus_demangle_with_scope(mangledName, DMGL_PARAMS | DMGL_ANSI, &demangledScopeLength);
+    }
+
+    DemanglerString demangled(demangledName);
+
+    if (!demangled.Get())
+    {
+        DEMANGLE_STATS_COUNT(DemangleFailures);
+
+        if (cache)
+        {
+            cache->Add(mangledName, cacheOptions, std::string_view());
+        }
+
+        return false;
+    }
+
+    result.assign(demangled.Get());
+
+    if (format == DemangleFormat::FixedWidthTypes)
+    {
+        DEMANGLE_STATS_TIMER(ParameterSubstitution);
+
+        ConvertToFixedWidthTypes(result);
+    }
+
+    if (scopeLength)
+    {
+        *scopeLength = demangledScopeLength >= 0 ? static_cast<size_t>(demangledScopeLength) : std::string::npos;
+
+        if (cache)
+        {
+            std::string cachedValue = result;
+
+            if (*scopeLength != std::string::npos)
+            {
+                cachedValue += '\0';
+                cachedValue += std::to_string(*scopeLength);
+            }
+
+            cache->Add(mangledName, cacheOptions, cachedValue);
+        }
+    }
+    else if (cache)
+    {
+        cache->Add(mangledName, cacheOptions, result);
+    }
+
+    return true;
+}
+
+bool TryDemangle(const char* const mangledName, DemangleFormat format, std::string& result)
+{
+    return DemangleName(mangledName, format, result, nullptr);
+}
+
+bool TryDemangleWithScope(const char* const mangledName, std::string& result, size_t& scopeLength)
+{
+    return DemangleName(mangledName, DemangleFormat::Classic, result, &scopeLength);
+}
+
+std::string GetDemangledLine(const char* const mangledLine)
+{
+    std::string result;
+
+    if (!TryDemangle(mangledLine, DemangleFormat::FixedWidthTypes, result))
+    {
+        // The line is not a mangled name that the demangler recognizes, return it unchanged.
+        result.assign(mangledLine);
+    }
+
+    return result;
+}
+
+bool IsPossibleMangledName(std::string_view name) noexcept
+{
+    // Every GNU v2 mangled name either contains the "__" separator between the function name and
+    // its signature, or is one of the special forms that start with an underscore and contain
+    // a CPLUS_MARKER character, e.g. _$_3foo, _vt$3foo or _GLOBAL_$I$3foo.
+
+    if (name.length() < 3)
+    {
+        return false;
+    }
+
+    if (name.find("__") != std::string_view::npos)
+    {
+        return true;
+    }
+
+    return name[0] == '_' && name.find_first_of("$.", 1) != std::string_view::npos;
+}
@@ -0,0 +1,64 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class PersistentDemangleCache;
+
+enum class DemangleFormat
+{
+    // The output of the egcs-1.1.2 demangler, e.g. cRZSample::Foo(unsigned int).
+    Classic,
+    // The parameter types are converted to their fixed-width equivalents, e.g. cRZSample::Foo(uint32_t).
+    FixedWidthTypes
+};
+
+// Identifies the output of the FixedWidthTypes format in caches and build manifests.
+// Increment it when the parameter type substitutions change.
+constexpr uint32_t ParameterSubstitutionsVersion = 1;
+
+// Demangles the function name using the specified output format.
+// Returns false if the name cannot be demangled.
+bool TryDemangle(const char* const mangledName, DemangleFormat format, std::string& result);
+
+// Demangles the function name using the Classic format, and returns the length of the class or namespace scope
+// at the start of the result that the demangler recorded, e.g. 9 for cRZSample::Foo(unsigned int), or
+// std::string::npos if the result does not start with a scope.
+// Returns false if the name cannot be demangled.
+bool TryDemangleWithScope(const char* const mangledName, std::string& result, size_t& scopeLength);
+
+// Converts the parameter types of a name in the Classic format to their fixed-width equivalents.
+void ConvertToFixedWidthTypes(std::string& demangledName);
+
+// Sets the on-disk cache that TryDemangle uses to store its results, or nullptr to disable it.
+// The cache must remain valid until it is removed.
+void SetPersistentDemangleCache(PersistentDemangleCache* cache) noexcept;
+
+// Demangles the function name and converts the parameter types to their fixed-width equivalents.
+// The function name is returned unchanged if it cannot be demangled.
+std::string GetDemangledLine(const char* const mangledLine);
+
+// Returns false for names that the demangler will always reject.
+// This is used to skip identifiers that cannot be GNU v2 mangled names without calling the demangler.
+bool IsPossibleMangledName(std::string_view name) noexcept;
@@ -0,0 +1,83 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "Demangler.h"
+#include <cstring>
+
+Demangler::Demangler(DemangleFormat format, std::pmr::memory_resource* upstream)
+    : format(format), arena(64 * 1024, upstream)
+{
+}
+
+std::string_view Demangler::Demangle(std::string_view mangledName)
+{
+    nameBuffer.assign(mangledName);
+
+    if (!TryDemangle(nameBuffer.c_str(), format, result))
+    {
+        return std::string_view();
+    }
+
+    char* const data = static_cast<char*>(arena.allocate(result.size(), alignof(char)));
+    std::memcpy(data, result.data(), result.size());
+
+    return std::string_view(data, result.size());
+}
+
+void Demangler::DemangleBatch(const std::vector<std::string_view>& mangledNames, std::vector<std::string_view>& results)
+{
+    results.resize(mangledNames.size());
+
+    for (size_t i = 0; i < mangledNames.size(); i++)
+    {
+        results[i] = Demangle(mangledNames[i]);
+    }
+}
+
+const DemangleTree* Demangler::DemangleToTree(std::string_view mangledName)
+{
+    nameBuffer.assign(mangledName);
+
+    return BuildDemangleTree(nameBuffer.c_str(), arena);
+}
+
+void Demangler::WriteClassHeader(std::istream& classDump, std::ostream& header, std::vector<MalformedLine>& malformedLines)
+{
+    DemangleClassDump(classDump, header, malformedLines);
+}
+
+size_t Demangler::WriteClassHeaders(
+    const std::vector<std::string_view>& mangledNames,
+    const std::filesystem::path& outputDirectory,
+    ThreadPool& threadPool)
+{
+    return GenerateClassHeaders(mangledNames, outputDirectory, threadPool);
+}
+
+void Demangler::ClearResults() noexcept
+{
+    arena.release();
+}
+
+DemangleFormat Demangler::GetFormat() const noexcept
+{
+    return format;
+}
@@ -0,0 +1,102 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ClassDump.h"
+#include "DemangleTree.h"
+#include "DemangleUtil.h"
+#include "HeaderGenerator.h"
+#include "ThreadPool.h"
+#include <filesystem>
+#include <istream>
+#include <memory_resource>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct DemangledSymbol
+{
+    std::string_view mangledName;
+    // Empty if the name cannot be demangled.
+    std::string_view demangledName;
+};
+
+// The entry point for applications that use the demangler as a library.
+// The demangled names are stored in an arena that is owned by the Demangler, the views that it
+// returns remain valid until ClearResults is called or the Demangler is destroyed.
+// A Demangler is not thread-safe, use one Demangler per thread.
+class Demangler
+{
+public:
+    // The arena allocates its memory blocks from the upstream memory resource.
+    explicit Demangler(
+        DemangleFormat format = DemangleFormat::FixedWidthTypes,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    Demangler(const Demangler&) = delete;
+    Demangler& operator=(const Demangler&) = delete;
+
+    // Returns the demangled name, or an empty view if the name cannot be demangled.
+    std::string_view Demangle(std::string_view mangledName);
+
+    // Demangles the names, the results are in the same order as the names.
+    void DemangleBatch(const std::vector<std::string_view>& mangledNames, std::vector<std::string_view>& results);
+
+    // Returns the parse tree of the demangled name, or nullptr if the name cannot be demangled.
+    // The tree is parsed from the classic demangler output and does not depend on the format.
+    const DemangleTree* DemangleToTree(std::string_view mangledName);
+
+    // Returns a view of DemangledSymbol values that demangles each name when it is read,
+    // e.g. for (const DemangledSymbol& symbol : demangler.DemangleLazy(symbolList.GetNames())).
+    template <std::ranges::viewable_range Range>
+    auto DemangleLazy(Range&& mangledNames)
+    {
+        return std::views::transform(
+            std::forward<Range>(mangledNames),
+            [this](std::string_view name) { return DemangledSymbol{ name, Demangle(name) }; });
+    }
+
+    // Converts a class dump with one mangled name per line to a header.
+    // The headers always use the fixed-width parameter types.
+    void WriteClassHeader(std::istream& classDump, std::ostream& header, std::vector<MalformedLine>& malformedLines);
+
+    // Groups the methods by class and writes one header per class, see GenerateClassHeaders.
+    // The names must be null-terminated, e.g. the names of a SymbolList.
+    size_t WriteClassHeaders(
+        const std::vector<std::string_view>& mangledNames,
+        const std::filesystem::path& outputDirectory,
+        ThreadPool& threadPool);
+
+    // Releases the memory of all of the demangled names.
+    void ClearResults() noexcept;
+
+    DemangleFormat GetFormat() const noexcept;
+
+private:
+    DemangleFormat format;
+    std::pmr::monotonic_buffer_resource arena;
+    // The demangler requires a null-terminated string.
+    std::string nameBuffer;
+    std::string result;
+};
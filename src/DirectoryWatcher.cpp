@@ -0,0 +1,283 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "DirectoryWatcher.h"
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace
+{
+    // The time to wait for more changes after the first one, this combines the events of a single save.
+    constexpr int CoalesceMilliseconds = 10;
+
+    void AddChange(DirectoryChanges& changes, std::filesystem::path&& path, DirectoryChangeType type)
+    {
+        for (DirectoryChange& item : changes.files)
+        {
+            if (item.path == path)
+            {
+                // The last change to the file wins.
+                item.type = type;
+                return;
+            }
+        }
+
+        changes.files.push_back(DirectoryChange{ std::move(path), type });
+    }
+}
+
+#if defined(_WIN32)
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path& directory)
+    : directory(directory)
+{
+    directoryHandle = CreateFileW(
+        directory.c_str(),
+        FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS,
+        nullptr);
+
+    if (directoryHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open the directory: " + directory.string());
+    }
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    CloseHandle(directoryHandle);
+}
+
+DirectoryChanges DirectoryWatcher::WaitForChanges()
+{
+    DirectoryChanges changes{};
+    alignas(DWORD) uint8_t buffer[64 * 1024];
+
+    do
+    {
+        DWORD bytesReturned = 0;
+
+        if (!ReadDirectoryChangesW(
+            directoryHandle,
+            buffer,
+            sizeof(buffer),
+            FALSE,
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+            &bytesReturned,
+            nullptr,
+            nullptr))
+        {
+            throw std::runtime_error("Failed to read the directory changes: " + directory.string());
+        }
+
+        if (bytesReturned == 0)
+        {
+            // The notification buffer overflowed.
+            changes.rescanRequired = true;
+            continue;
+        }
+
+        for (size_t offset = 0;;)
+        {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            const std::wstring_view fileName(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            const bool removed = info->Action == FILE_ACTION_REMOVED || info->Action == FILE_ACTION_RENAMED_OLD_NAME;
+
+            AddChange(changes, directory / fileName, removed ? DirectoryChangeType::Removed : DirectoryChangeType::Modified);
+
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+
+            offset += info->NextEntryOffset;
+        }
+
+        // Give the writer a moment to finish, the changes that arrive in the meantime are read by the next call.
+        Sleep(CoalesceMilliseconds);
+    } while (changes.files.empty() && !changes.rescanRequired);
+
+    return changes;
+}
+#elif defined(__linux__)
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path& directory)
+    : directory(directory)
+{
+    inotifyFd = inotify_init1(IN_CLOEXEC);
+
+    if (inotifyFd == -1)
+    {
+        throw std::runtime_error("Failed to initialize inotify.");
+    }
+
+    if (inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) == -1)
+    {
+        close(inotifyFd);
+        throw std::runtime_error("Failed to watch the directory: " + directory.string());
+    }
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    close(inotifyFd);
+}
+
+DirectoryChanges DirectoryWatcher::WaitForChanges()
+{
+    DirectoryChanges changes{};
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    // The first read blocks until a change arrives, the following reads collect the rest of the burst.
+    for (bool blocking = true;;)
+    {
+        if (!blocking)
+        {
+            pollfd fd{ inotifyFd, POLLIN, 0 };
+            const int ready = poll(&fd, 1, CoalesceMilliseconds);
+
+            if (ready < 0)
+            {
+                continue;
+            }
+            else if (ready == 0)
+            {
+                if (!changes.files.empty() || changes.rescanRequired)
+                {
+                    break;
+                }
+
+                // None of the events named a file, wait for the next change.
+                blocking = true;
+                continue;
+            }
+        }
+
+        const ssize_t bytesRead = read(inotifyFd, buffer, sizeof(buffer));
+
+        if (bytesRead <= 0)
+        {
+            if (bytesRead == -1 && errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::runtime_error("Failed to read the directory changes: " + directory.string());
+        }
+
+        for (ssize_t offset = 0; offset < bytesRead;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                changes.rescanRequired = true;
+            }
+            else if (event->len > 0)
+            {
+                const DirectoryChangeType type = (event->mask & (IN_MOVED_FROM | IN_DELETE)) ? DirectoryChangeType::Removed : DirectoryChangeType::Modified;
+
+                AddChange(changes, directory / event->name, type);
+            }
+
+            offset += sizeof(inotify_event) + event->len;
+        }
+
+        blocking = false;
+    }
+
+    return changes;
+}
+#else
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path& directory)
+    : directory(directory), knownFiles(GetFileStates())
+{
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+}
+
+std::unordered_map<std::filesystem::path::string_type, DirectoryWatcher::FileState> DirectoryWatcher::GetFileStates() const
+{
+    std::unordered_map<std::filesystem::path::string_type, FileState> states;
+    std::error_code ec;
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        if (entry.is_regular_file(ec))
+        {
+            states.try_emplace(entry.path().native(), FileState{ entry.last_write_time(ec), entry.file_size(ec) });
+        }
+    }
+
+    return states;
+}
+
+DirectoryChanges DirectoryWatcher::WaitForChanges()
+{
+    // The platform has no change notification API that is supported, poll the directory instead.
+    DirectoryChanges changes{};
+
+    while (changes.files.empty())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        auto currentFiles = GetFileStates();
+
+        for (const auto& [path, state] : currentFiles)
+        {
+            const auto it = knownFiles.find(path);
+
+            if (it == knownFiles.end() || it->second.lastWriteTime != state.lastWriteTime || it->second.size != state.size)
+            {
+                AddChange(changes, std::filesystem::path(path), DirectoryChangeType::Modified);
+            }
+        }
+
+        for (const auto& item : knownFiles)
+        {
+            if (!currentFiles.contains(item.first))
+            {
+                AddChange(changes, std::filesystem::path(item.first), DirectoryChangeType::Removed);
+            }
+        }
+
+        knownFiles = std::move(currentFiles);
+    }
+
+    return changes;
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class DirectoryChangeType
+{
+    // The file was created, written or renamed into the directory.
+    Modified,
+    // The file was deleted or renamed out of the directory.
+    Removed
+};
+
+struct DirectoryChange
+{
+    std::filesystem::path path;
+    DirectoryChangeType type;
+};
+
+struct DirectoryChanges
+{
+    std::vector<DirectoryChange> files;
+    // Set when the operating system dropped change notifications, the caller must check every file.
+    bool rescanRequired;
+};
+
+// Reports changes to the files in a directory, subdirectories are not watched.
+// inotify is used on Linux and ReadDirectoryChangesW on Windows, other platforms poll the directory.
+class DirectoryWatcher
+{
+public:
+    explicit DirectoryWatcher(const std::filesystem::path& directory);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // Blocks until at least one file changes. Changes that arrive in a short burst, e.g. an editor
+    // writing a temporary file and renaming it, are combined and each file is reported once.
+    DirectoryChanges WaitForChanges();
+
+private:
+    std::filesystem::path directory;
+#if defined(_WIN32)
+    void* directoryHandle;
+#elif defined(__linux__)
+    int inotifyFd;
+#else
+    struct FileState
+    {
+        std::filesystem::file_time_type lastWriteTime;
+        uintmax_t size;
+    };
+
+    std::unordered_map<std::filesystem::path::string_type, FileState> GetFileStates() const;
+
+    std::unordered_map<std::filesystem::path::string_type, FileState> knownFiles;
+#endif
+};
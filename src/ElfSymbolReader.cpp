@@ -0,0 +1,267 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "ElfSymbolReader.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // The ELF32 structures, see the System V Application Binary Interface specification.
+
+    constexpr size_t EI_NIDENT = 16;
+    constexpr uint8_t ELFCLASS32 = 1;
+    constexpr uint8_t ELFDATA2LSB = 1;
+    constexpr uint32_t SHT_SYMTAB = 2;
+    constexpr uint32_t SHT_DYNSYM = 11;
+    constexpr uint16_t SHN_UNDEF = 0;
+    constexpr uint16_t SHN_LORESERVE = 0xff00;
+
+    struct Elf32_Ehdr
+    {
+        uint8_t e_ident[EI_NIDENT];
+        uint16_t e_type;
+        uint16_t e_machine;
+        uint32_t e_version;
+        uint32_t e_entry;
+        uint32_t e_phoff;
+        uint32_t e_shoff;
+        uint32_t e_flags;
+        uint16_t e_ehsize;
+        uint16_t e_phentsize;
+        uint16_t e_phnum;
+        uint16_t e_shentsize;
+        uint16_t e_shnum;
+        uint16_t e_shstrndx;
+    };
+
+    struct Elf32_Shdr
+    {
+        uint32_t sh_name;
+        uint32_t sh_type;
+        uint32_t sh_flags;
+        uint32_t sh_addr;
+        uint32_t sh_offset;
+        uint32_t sh_size;
+        uint32_t sh_link;
+        uint32_t sh_info;
+        uint32_t sh_addralign;
+        uint32_t sh_entsize;
+    };
+
+    struct Elf32_Sym
+    {
+        uint32_t st_name;
+        uint32_t st_value;
+        uint32_t st_size;
+        uint8_t st_info;
+        uint8_t st_other;
+        uint16_t st_shndx;
+    };
+
+    static_assert(sizeof(Elf32_Ehdr) == 52);
+    static_assert(sizeof(Elf32_Shdr) == 40);
+    static_assert(sizeof(Elf32_Sym) == 16);
+
+    template <typename T> T ReadStructure(const uint8_t* data, size_t dataSize, uint64_t offset)
+    {
+        if (offset > dataSize || dataSize - offset < sizeof(T))
+        {
+            throw std::runtime_error("The ELF file is truncated.");
+        }
+
+        // The structures are copied because the file data is not guaranteed to be aligned.
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+
+        return value;
+    }
+
+    class StringTable
+    {
+    public:
+        StringTable(const uint8_t* data, size_t dataSize, const Elf32_Shdr& header)
+        {
+            if (header.sh_offset > dataSize || dataSize - header.sh_offset < header.sh_size)
+            {
+                throw std::runtime_error("The ELF string table is truncated.");
+            }
+
+            start = reinterpret_cast<const char*>(data + header.sh_offset);
+            size = header.sh_size;
+        }
+
+        std::string_view Get(uint32_t offset) const noexcept
+        {
+            if (offset >= size)
+            {
+                return std::string_view();
+            }
+
+            // A string that is not null-terminated before the end of the table is treated as invalid,
+            // this ensures that every returned view is null-terminated.
+            const void* terminator = std::memchr(start + offset, '\0', size - offset);
+
+            if (!terminator)
+            {
+                return std::string_view();
+            }
+
+            return std::string_view(start + offset, static_cast<const char*>(terminator) - (start + offset));
+        }
+
+    private:
+        const char* start;
+        size_t size;
+    };
+}
+
+ElfSymbolReader::ElfSymbolReader(const std::filesystem::path& path)
+    : file(path), symbols(), sections(), isDynamicSymbolTable(false)
+{
+    const uint8_t* const data = file.Data();
+    const size_t dataSize = file.Size();
+
+    const Elf32_Ehdr header = ReadStructure<Elf32_Ehdr>(data, dataSize, 0);
+
+    if (std::memcmp(header.e_ident, "\x7f" "ELF", 4) != 0)
+    {
+        throw std::runtime_error("The file is not an ELF file.");
+    }
+
+    if (header.e_ident[4] != ELFCLASS32 || header.e_ident[5] != ELFDATA2LSB)
+    {
+        throw std::runtime_error("Only 32-bit little-endian ELF files are supported.");
+    }
+
+    if (header.e_shentsize != sizeof(Elf32_Shdr))
+    {
+        throw std::runtime_error("The ELF section header size is invalid.");
+    }
+
+    std::vector<Elf32_Shdr> sectionHeaders;
+    sectionHeaders.reserve(header.e_shnum);
+
+    for (uint16_t i = 0; i < header.e_shnum; i++)
+    {
+        sectionHeaders.push_back(ReadStructure<Elf32_Shdr>(data, dataSize, header.e_shoff + (static_cast<uint64_t>(i) * sizeof(Elf32_Shdr))));
+    }
+
+    if (header.e_shstrndx >= sectionHeaders.size())
+    {
+        throw std::runtime_error("The ELF section name table index is invalid.");
+    }
+
+    const StringTable sectionNames(data, dataSize, sectionHeaders[header.e_shstrndx]);
+
+    sections.reserve(sectionHeaders.size());
+
+    for (const Elf32_Shdr& section : sectionHeaders)
+    {
+        sections.push_back(ElfSection{ sectionNames.Get(section.sh_name), section.sh_addr, section.sh_size });
+    }
+
+    // Prefer the full symbol table, a stripped executable only has the dynamic symbols.
+    const Elf32_Shdr* symbolTable = nullptr;
+
+    for (const Elf32_Shdr& section : sectionHeaders)
+    {
+        if (section.sh_type == SHT_SYMTAB)
+        {
+            symbolTable = &section;
+            isDynamicSymbolTable = false;
+            break;
+        }
+        else if (section.sh_type == SHT_DYNSYM && !symbolTable)
+        {
+            symbolTable = &section;
+            isDynamicSymbolTable = true;
+        }
+    }
+
+    if (!symbolTable)
+    {
+        throw std::runtime_error("The ELF file does not have a symbol table.");
+    }
+
+    if (symbolTable->sh_link >= sectionHeaders.size())
+    {
+        throw std::runtime_error("The ELF symbol string table index is invalid.");
+    }
+
+    // Check the range before the size is used to reserve the symbols, a corrupt size would otherwise be allocated.
+    if (symbolTable->sh_offset > dataSize || dataSize - symbolTable->sh_offset < symbolTable->sh_size)
+    {
+        throw std::runtime_error("The ELF symbol table is truncated.");
+    }
+
+    const StringTable symbolNames(data, dataSize, sectionHeaders[symbolTable->sh_link]);
+    const uint32_t symbolCount = symbolTable->sh_size / sizeof(Elf32_Sym);
+
+    symbols.reserve(symbolCount);
+
+    for (uint32_t i = 0; i < symbolCount; i++)
+    {
+        const Elf32_Sym symbol = ReadStructure<Elf32_Sym>(
+            data,
+            dataSize,
+            symbolTable->sh_offset + (static_cast<uint64_t>(i) * sizeof(Elf32_Sym)));
+
+        const std::string_view name = symbolNames.Get(symbol.st_name);
+
+        if (name.empty())
+        {
+            continue;
+        }
+
+        std::string_view sectionName;
+
+        if (symbol.st_shndx != SHN_UNDEF && symbol.st_shndx < SHN_LORESERVE && symbol.st_shndx < sectionHeaders.size())
+        {
+            sectionName = sections[symbol.st_shndx].name;
+        }
+
+        symbols.push_back(ElfSymbol
+        {
+            name,
+            sectionName,
+            symbol.st_value,
+            symbol.st_size,
+            symbol.st_shndx,
+            static_cast<ElfSymbolType>(symbol.st_info & 0xf)
+        });
+    }
+}
+
+const std::vector<ElfSymbol>& ElfSymbolReader::GetSymbols() const noexcept
+{
+    return symbols;
+}
+
+const std::vector<ElfSection>& ElfSymbolReader::GetSections() const noexcept
+{
+    return sections;
+}
+
+bool ElfSymbolReader::IsDynamicSymbolTable() const noexcept
+{
+    return isDynamicSymbolTable;
+}
@@ -0,0 +1,82 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "MemoryMappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+enum class ElfSymbolType : uint8_t
+{
+    NoType = 0,
+    Object = 1,
+    Function = 2,
+    Section = 3,
+    File = 4
+};
+
+struct ElfSymbol
+{
+    // The name points into the mapped string table and is null-terminated,
+    // so it can be passed to the demangler without copying it.
+    std::string_view name;
+    // The name of the section that the symbol is defined in, empty for undefined and absolute symbols.
+    std::string_view sectionName;
+    uint32_t value;
+    uint32_t size;
+    uint16_t sectionIndex;
+    ElfSymbolType type;
+};
+
+struct ElfSection
+{
+    std::string_view name;
+    // The address of the section when the file is loaded, zero for the sections that are not loaded.
+    uint32_t address;
+    uint32_t size;
+};
+
+// Reads the symbol table of a 32-bit little-endian ELF file, e.g. the SC3U Linux executable.
+// The file is memory mapped and the symbol names are used in place.
+class ElfSymbolReader
+{
+public:
+    explicit ElfSymbolReader(const std::filesystem::path& path);
+
+    // The symbols from the static symbol table (.symtab), or from the dynamic
+    // symbol table (.dynsym) if the file has been stripped.
+    // Symbols without a name are skipped.
+    const std::vector<ElfSymbol>& GetSymbols() const noexcept;
+
+    // The section headers, indexed by ElfSymbol::sectionIndex.
+    const std::vector<ElfSection>& GetSections() const noexcept;
+
+    // Returns true if the symbols were read from the dynamic symbol table.
+    bool IsDynamicSymbolTable() const noexcept;
+
+private:
+    MemoryMappedFile file;
+    std::vector<ElfSymbol> symbols;
+    std::vector<ElfSection> sections;
+    bool isDynamicSymbolTable;
+};
@@ -0,0 +1,267 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "HardwareCounters.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static constexpr std::array<const char*, static_cast<size_t>(HardwareCounter::Count)> CounterNames
+{
+    "cycles",
+    "instructions",
+    "L1d misses",
+    "LLC misses",
+    "branch misses"
+};
+
+#if defined(__linux__)
+
+namespace
+{
+    struct CounterConfig
+    {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    constexpr std::array<CounterConfig, static_cast<size_t>(HardwareCounter::Count)> CounterConfigs
+    {{
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        {
+            PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+        },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    }};
+
+    // The values of a counter opened with PERF_FORMAT_TOTAL_TIME_ENABLED and PERF_FORMAT_TOTAL_TIME_RUNNING.
+    struct CounterReading
+    {
+        uint64_t value;
+        uint64_t timeEnabled;
+        uint64_t timeRunning;
+    };
+
+    int OpenCounter(const CounterConfig& counterConfig, HardwareCounterScope scope) noexcept
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.type = counterConfig.type;
+        attr.config = counterConfig.config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // The new threads inherit the counters, the ioctl calls and reads of the counters include them.
+        attr.inherit = scope == HardwareCounterScope::CallingThreadAndNewThreads;
+
+        // Count the calling thread on any CPU.
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+}
+
+HardwareCounters::HardwareCounters(HardwareCounterScope scope) noexcept
+{
+    int firstError = 0;
+
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        fds[i] = OpenCounter(CounterConfigs[i], scope);
+
+        if (fds[i] == -1 && firstError == 0)
+        {
+            firstError = errno;
+        }
+    }
+
+    if (!IsAvailable())
+    {
+        try
+        {
+            unavailableReason = std::string("perf_event_open failed: ") + std::strerror(firstError);
+
+            if (firstError == EACCES || firstError == EPERM)
+            {
+                unavailableReason += ", check /proc/sys/kernel/perf_event_paranoid";
+            }
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+HardwareCounters::~HardwareCounters()
+{
+    for (const int fd : fds)
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+}
+
+bool HardwareCounters::IsAvailable() const noexcept
+{
+    for (const int fd : fds)
+    {
+        if (fd != -1)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void HardwareCounters::Start() noexcept
+{
+    for (const int fd : fds)
+    {
+        if (fd != -1)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+HardwareCounterValues HardwareCounters::Stop() noexcept
+{
+    HardwareCounterValues result;
+
+    for (const int fd : fds)
+    {
+        if (fd != -1)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        CounterReading reading;
+
+        if (fds[i] == -1 || read(fds[i], &reading, sizeof(reading)) != sizeof(reading) || reading.timeRunning == 0)
+        {
+            continue;
+        }
+
+        // The kernel multiplexes the counters when there are more events than hardware counters,
+        // scale the value to the time that the counter was enabled.
+        if (reading.timeRunning < reading.timeEnabled)
+        {
+            reading.value = static_cast<uint64_t>(static_cast<double>(reading.value) * reading.timeEnabled / reading.timeRunning);
+        }
+
+        result.values[i] = reading.value;
+        result.available[i] = true;
+    }
+
+    return result;
+}
+
+#else
+
+HardwareCounters::HardwareCounters(HardwareCounterScope) noexcept
+{
+    fds.fill(-1);
+
+    try
+    {
+        unavailableReason = "hardware counters are only supported on Linux";
+    }
+    catch (...)
+    {
+    }
+}
+
+HardwareCounters::~HardwareCounters()
+{
+}
+
+bool HardwareCounters::IsAvailable() const noexcept
+{
+    return false;
+}
+
+void HardwareCounters::Start() noexcept
+{
+}
+
+HardwareCounterValues HardwareCounters::Stop() noexcept
+{
+    return HardwareCounterValues();
+}
+
+#endif
+
+const std::string& HardwareCounters::GetUnavailableReason() const noexcept
+{
+    return unavailableReason;
+}
+
+const char* HardwareCounters::GetName(HardwareCounter counter) noexcept
+{
+    return CounterNames[static_cast<size_t>(counter)];
+}
+
+void WriteHardwareCounters(std::ostream& out, const HardwareCounterValues& counters, double count, const char* unit)
+{
+    bool first = true;
+
+    for (size_t i = 0; i < counters.values.size(); i++)
+    {
+        const HardwareCounter counter = static_cast<HardwareCounter>(i);
+
+        if (counters.IsAvailable(counter))
+        {
+            out << (first ? "    " : ", ") << (static_cast<double>(counters.values[i]) / count) << " " << HardwareCounters::GetName(counter);
+            first = false;
+        }
+    }
+
+    if (counters.IsAvailable(HardwareCounter::Cycles) && counters.IsAvailable(HardwareCounter::Instructions) && counters.Get(HardwareCounter::Cycles) > 0)
+    {
+        const std::streamsize precision = out.precision(2);
+
+        out << ", " << (static_cast<double>(counters.Get(HardwareCounter::Instructions)) / static_cast<double>(counters.Get(HardwareCounter::Cycles)))
+            << " IPC";
+        out.precision(precision);
+    }
+
+    if (!first)
+    {
+        out << " per " << unit << std::endl;
+    }
+}
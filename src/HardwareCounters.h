@@ -0,0 +1,92 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+enum class HardwareCounter
+{
+    Cycles,
+    Instructions,
+    L1DataMisses,
+    LastLevelCacheMisses,
+    BranchMisses,
+    Count
+};
+
+enum class HardwareCounterScope
+{
+    CallingThread,
+    // Also counts the threads that the calling thread creates after the counters are opened,
+    // e.g. the workers of a ThreadPool that is constructed after the HardwareCounters.
+    CallingThreadAndNewThreads
+};
+
+struct HardwareCounterValues
+{
+    std::array<uint64_t, static_cast<size_t>(HardwareCounter::Count)> values{};
+    std::array<bool, static_cast<size_t>(HardwareCounter::Count)> available{};
+
+    uint64_t Get(HardwareCounter counter) const noexcept
+    {
+        return values[static_cast<size_t>(counter)];
+    }
+
+    bool IsAvailable(HardwareCounter counter) const noexcept
+    {
+        return available[static_cast<size_t>(counter)];
+    }
+};
+
+// Counts the hardware events of the calling thread, or of the scope, between Start and Stop, using perf_event_open on Linux.
+// The counters that the CPU, the kernel or the permissions do not allow are reported as unavailable,
+// on the other platforms none of the counters are available.
+class HardwareCounters
+{
+public:
+    explicit HardwareCounters(HardwareCounterScope scope = HardwareCounterScope::CallingThread) noexcept;
+    ~HardwareCounters();
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool IsAvailable() const noexcept;
+
+    // Describes why none of the counters could be opened.
+    const std::string& GetUnavailableReason() const noexcept;
+
+    void Start() noexcept;
+    HardwareCounterValues Stop() noexcept;
+
+    static const char* GetName(HardwareCounter counter) noexcept;
+
+private:
+    std::array<int, static_cast<size_t>(HardwareCounter::Count)> fds;
+    std::string unavailableReason;
+};
+
+// Writes the available counters divided by the count and the instructions per cycle on an indented line,
+// e.g. "    250.0 cycles, 600.0 instructions, 2.40 IPC per symbol". Nothing is written when no counter is available.
+void WriteHardwareCounters(std::ostream& out, const HardwareCounterValues& counters, double count, const char* unit);
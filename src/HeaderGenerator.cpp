@@ -0,0 +1,291 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "HeaderGenerator.h"
+#include "BuildManifest.h"
+#include "DemangleStats.h"
+#include "DemangleTree.h"
+#include "DemangleUtil.h"
+#include "HeaderWriter.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <iomanip>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    struct ClassMethod
+    {
+        std::string className;
+        std::string method;
+    };
+
+    struct ClassInfo
+    {
+        std::string name;
+        std::vector<std::string> methods;
+        std::unordered_set<std::string> seenMethods;
+    };
+
+    // Splits a demangled name such as cRZSample::Foo(int32_t) into the class name and the method at the end of
+    // the scope of its tree. Names that are not class methods, e.g. virtual tables, thunks and free functions, are rejected.
+    bool DemangleClassMethod(const char* mangledName, std::pmr::memory_resource& arena, std::string& demangled, ClassMethod& result)
+    {
+        const DemangleTree* const tree = BuildDemangleTree(mangledName, arena);
+
+        if (!tree || tree->kind != DemangleTreeKind::Function)
+        {
+            return false;
+        }
+
+        // The headers use the same text as the FixedWidthTypes format.
+        demangled.assign(tree->text);
+
+        {
+            DEMANGLE_STATS_TIMER(ParameterSubstitution);
+            ConvertToFixedWidthTypes(demangled);
+        }
+
+        const size_t scopeEnd = FindDemangleTreeScopeEnd(*tree, demangled);
+
+        if (scopeEnd == std::string::npos)
+        {
+            return false;
+        }
+
+        result.className = demangled.substr(0, scopeEnd);
+        result.method = demangled.substr(scopeEnd + 2);
+
+        return true;
+    }
+
+    bool IsGZUnknownClass(const ClassInfo& info)
+    {
+        return std::find(info.methods.begin(), info.methods.end(), QueryInterfaceMethod) != info.methods.end();
+    }
+
+    bool IsInvalidFileNameCharacter(char c)
+    {
+        return c == ':' || c == '<' || c == '>' || c == ',' || c == ' ' || c == '*' || c == '&';
+    }
+
+    std::string GetHeaderFileName(const std::string& className)
+    {
+        std::string fileName = className;
+
+        // Nested and template class names contain characters that are not valid in a file name.
+        std::replace_if(fileName.begin(), fileName.end(), IsInvalidFileNameCharacter, '_');
+
+        return fileName;
+    }
+
+    // The file names are compared without case, the Windows file systems do not distinguish them.
+    std::string GetFileNameKey(std::string fileName)
+    {
+        std::transform(fileName.begin(), fileName.end(), fileName.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+        return fileName;
+    }
+
+    // Returns the header file name of each class name. Different class names can map to the same file name,
+    // e.g. A<B> and A_B_, or names that only differ in case. Of each group of such names, the first name in sorted
+    // order that is a valid file name keeps its file name and the others get a suffix with the hash of their class
+    // name, so the file names do not depend on the order of the symbols.
+    std::vector<std::string> GetHeaderFileNames(const std::vector<std::string>& classNames)
+    {
+        std::vector<std::string> fileNames;
+        std::unordered_map<std::string, std::vector<size_t>> fileNameGroups;
+
+        fileNames.reserve(classNames.size());
+
+        for (size_t i = 0; i < classNames.size(); i++)
+        {
+            fileNames.push_back(GetHeaderFileName(classNames[i]));
+            fileNameGroups[GetFileNameKey(fileNames.back())].push_back(i);
+        }
+
+        for (auto& [key, group] : fileNameGroups)
+        {
+            if (group.size() == 1)
+            {
+                continue;
+            }
+
+            std::sort(group.begin(), group.end(), [&](size_t a, size_t b) { return classNames[a] < classNames[b]; });
+
+            bool plainNameUsed = false;
+
+            for (const size_t i : group)
+            {
+                const std::string& className = classNames[i];
+
+                if (!plainNameUsed && std::none_of(className.begin(), className.end(), IsInvalidFileNameCharacter))
+                {
+                    plainNameUsed = true;
+                    continue;
+                }
+
+                std::ostringstream suffix;
+                suffix << '_' << std::hex << std::setw(8) << std::setfill('0') << static_cast<uint32_t>(GetContentHash(className));
+
+                fileNames[i] += suffix.str();
+            }
+        }
+
+        // A suffixed name can still match another class name, e.g. a class that is named like a suffixed file.
+        std::unordered_map<std::string, size_t> usedFileNames;
+
+        for (size_t i = 0; i < fileNames.size(); i++)
+        {
+            auto [it, inserted] = usedFileNames.try_emplace(GetFileNameKey(fileNames[i]), i);
+
+            if (!inserted)
+            {
+                throw std::runtime_error(
+                    "The classes " + classNames[it->second] + " and " + classNames[i] + " map to the same header file: " + fileNames[i] + ".h");
+            }
+        }
+
+        return fileNames;
+    }
+
+    void WriteClassHeader(const std::filesystem::path& headerPath, const ClassInfo& info)
+    {
+        TRACE_SPAN("write");
+        const bool isGZUnknownClass = IsGZUnknownClass(info);
+
+        std::ostringstream out;
+
+        WriteHeaderStart(out, info.name, isGZUnknownClass);
+
+        for (const std::string& method : info.methods)
+        {
+            // The cIGZUnknown methods are declared by the base class.
+            if (isGZUnknownClass && (method == QueryInterfaceMethod || method == "AddRef(void)" || method == "Release(void)"))
+            {
+                continue;
+            }
+
+            WriteHeaderMethod(out, method);
+        }
+
+        WriteHeaderEnd(out);
+
+        // Unchanged headers are not rewritten, this keeps their modification times stable for incremental builds.
+        WriteFileIfChanged(headerPath, out.view());
+    }
+}
+
+size_t GenerateClassHeaders(
+    const std::vector<std::string_view>& mangledNames,
+    const std::filesystem::path& outputDirectory,
+    ThreadPool& threadPool)
+{
+    // Demangle the names in parallel, each chunk keeps the names in their input order.
+    const size_t chunkCount = std::max<size_t>(1, std::min(mangledNames.size() / 1024, threadPool.GetThreadCount() * 4));
+    const size_t chunkSize = (mangledNames.size() + chunkCount - 1) / chunkCount;
+    std::vector<std::vector<ClassMethod>> chunkResults(chunkCount);
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        threadPool.Submit([&, chunk]()
+        {
+            TRACE_SPAN("demangle batch");
+            const size_t start = chunk * chunkSize;
+            const size_t end = std::min(start + chunkSize, mangledNames.size());
+            std::vector<ClassMethod>& results = chunkResults[chunk];
+            std::string demangled;
+            ClassMethod item;
+            // The tree of each name is only needed until it has been split, the arena is reset for every name.
+            std::array<std::byte, 16384> arenaBuffer;
+            std::pmr::monotonic_buffer_resource arena(arenaBuffer.data(), arenaBuffer.size());
+
+            for (size_t i = start; i < end; i++)
+            {
+                // The names are null-terminated views, see SymbolList.
+                if (DemangleClassMethod(mangledNames[i].data(), arena, demangled, item))
+                {
+                    results.push_back(std::move(item));
+                }
+
+                arena.release();
+            }
+        });
+    }
+
+    threadPool.Wait();
+
+    // Build the class index, the methods of each class are kept in the order they were first seen.
+    std::vector<ClassInfo> classes;
+    std::unordered_map<std::string, size_t> classIndex;
+
+    for (std::vector<ClassMethod>& results : chunkResults)
+    {
+        for (ClassMethod& item : results)
+        {
+            auto [it, inserted] = classIndex.try_emplace(item.className, classes.size());
+
+            if (inserted)
+            {
+                classes.emplace_back().name = std::move(item.className);
+            }
+
+            ClassInfo& info = classes[it->second];
+
+            if (info.seenMethods.insert(item.method).second)
+            {
+                info.methods.push_back(std::move(item.method));
+            }
+        }
+
+        results = std::vector<ClassMethod>();
+    }
+
+    // The cIGZUnknown headers are named after their interface class.
+    std::vector<std::string> headerClassNames;
+    headerClassNames.reserve(classes.size());
+
+    for (const ClassInfo& info : classes)
+    {
+        headerClassNames.push_back(IsGZUnknownClass(info) ? GetInterfaceClassName(info.name) : info.name);
+    }
+
+    const std::vector<std::string> fileNames = GetHeaderFileNames(headerClassNames);
+
+    std::filesystem::create_directories(outputDirectory);
+
+    for (size_t i = 0; i < classes.size(); i++)
+    {
+        threadPool.Submit([&outputDirectory, &classes, &fileNames, i]() { WriteClassHeader(outputDirectory / (fileNames[i] + ".h"), classes[i]); });
+    }
+
+    threadPool.Wait();
+
+    return classes.size();
+}
@@ -0,0 +1,34 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ThreadPool.h"
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+// Demangles the symbols, groups the methods by class name and writes one header per class
+// to the output directory. The demangling and the header writing are spread over the thread pool.
+// Returns the number of headers that were written.
+size_t GenerateClassHeaders(
+    const std::vector<std::string_view>& mangledNames,
+    const std::filesystem::path& outputDirectory,
+    ThreadPool& threadPool);
@@ -0,0 +1,75 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "HeaderWriter.h"
+
+std::string GetInterfaceClassName(std::string_view className)
+{
+    std::string interfaceName(className);
+
+    if (interfaceName.size() > 0 && interfaceName[0] == 'c')
+    {
+        if (interfaceName.starts_with("cRZ"))
+        {
+            // The cRZ class prefixes are changed to cIGZ.
+            // For example, cRZLanguageManager will be converted to cIGZLanguageManager.
+            interfaceName.replace(0, 3, "cIGZ");
+        }
+        else
+        {
+            // Change the class name to its interface form, the 'c' at the start of the name
+            // will be replaced with 'cI'.
+            // For example, cSC3App will be converted to cISC3App.
+            interfaceName.replace(0, 1, "cI");
+        }
+    }
+
+    return interfaceName;
+}
+
+void WriteHeaderStart(std::ostream& out, std::string_view className, bool isGZUnknownClass)
+{
+    if (isGZUnknownClass)
+    {
+        out << "#pragma once\n";
+        out << "#include \"cIGZUnknown.h\"\n\n";
+        out << "class " << GetInterfaceClassName(className) << " : public cIGZUnknown\n";
+        out << "{\n";
+        out << "public:\n";
+    }
+    else
+    {
+        out << "#pragma once\n\n";
+        out << "class " << className << '\n';
+        out << "{\n";
+        out << "public:\n";
+    }
+}
+
+void WriteHeaderMethod(std::ostream& out, std::string_view method)
+{
+    out << "    virtual void* " << method << " = 0;\n";
+}
+
+void WriteHeaderEnd(std::ostream& out)
+{
+    out << "};\n";
+}
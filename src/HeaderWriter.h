@@ -0,0 +1,45 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Identifies the header layout in build manifests, increment it when the written headers change.
+constexpr uint32_t HeaderFormatVersion = 2;
+
+// The first method of a class that implements the cIGZUnknown interface.
+constexpr std::string_view QueryInterfaceMethod = "QueryInterface(uint32_t, void**)";
+
+// Converts the class name to its interface form, e.g. cRZLanguageManager to cIGZLanguageManager
+// and cSC3App to cISC3App.
+std::string GetInterfaceClassName(std::string_view className);
+
+// Writes the start of the class declaration. When the class implements cIGZUnknown
+// the interface form of the class name is used.
+void WriteHeaderStart(std::ostream& out, std::string_view className, bool isGZUnknownClass);
+
+// Writes a method declaration, the method name must not include the class name.
+void WriteHeaderMethod(std::ostream& out, std::string_view method);
+
+void WriteHeaderEnd(std::ostream& out);
@@ -0,0 +1,127 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "LinePreprocessor.h"
+#include "DemangleStats.h"
+#include <charconv>
+
+static constexpr std::string_view VirtualFunctionPrototypePrefix = "virtual ";
+static constexpr std::string_view ThunkPrefix = "__thunk_";
+
+static LinePreprocessStatus SetMalformed(PreprocessedLine& result, const char* message) noexcept
+{
+    DEMANGLE_STATS_COUNT(MalformedLines);
+
+    result.errorMessage = message;
+    return LinePreprocessStatus::Malformed;
+}
+
+LinePreprocessStatus PreprocessLine(std::string_view line, PreprocessedLine& result) noexcept
+{
+    DEMANGLE_STATS_TIMER(PreprocessLine);
+
+    result = PreprocessedLine();
+
+    if (line.length() == 0)
+    {
+        DEMANGLE_STATS_COUNT(BlankLines);
+        return LinePreprocessStatus::BlankLine;
+    }
+
+    // Strip the virtual function prefix and suffix (if any), then strip the thunk prefix from
+    // the start of the mangled function name (if any).
+    // Both have to be removed for the GCC demangler to be able to process the function name.
+
+    if (line.starts_with(VirtualFunctionPrototypePrefix))
+    {
+        // The virtual function prototype uses the following format: virtual <return type> <mangled name>(<parameters>).
+        // Trim the view to keep only <mangled name>.
+
+        size_t functionReturnTypeEnd = line.find(' ', VirtualFunctionPrototypePrefix.size() + 1);
+
+        if (functionReturnTypeEnd == std::string_view::npos)
+        {
+            return SetMalformed(result, "Failed to find the end of the virtual function return type.");
+        }
+
+        size_t mangledNameStart = functionReturnTypeEnd + 1;
+        size_t mangledNameEnd = line.find('(', mangledNameStart);
+
+        if (mangledNameEnd == std::string_view::npos)
+        {
+            return SetMalformed(result, "Failed to find the end of the virtual function prototype prefix.");
+        }
+
+        size_t parametersEnd = line.rfind(')');
+
+        if (parametersEnd == std::string_view::npos || parametersEnd < mangledNameEnd)
+        {
+            parametersEnd = line.length();
+        }
+
+        DEMANGLE_STATS_COUNT(VirtualPrototypes);
+
+        result.isVirtualPrototype = true;
+        result.virtualReturnType = line.substr(
+            VirtualFunctionPrototypePrefix.size(),
+            functionReturnTypeEnd - VirtualFunctionPrototypePrefix.size());
+        result.virtualParameters = line.substr(mangledNameEnd + 1, parametersEnd - (mangledNameEnd + 1));
+
+        line = line.substr(mangledNameStart, mangledNameEnd - mangledNameStart);
+    }
+
+    if (line.starts_with(ThunkPrefix))
+    {
+        // The thunk prefix uses the format: __thunk_<unique number>_
+        // The function name follows this prefix.
+
+        size_t thunkPrefixEnd = line.find('_', ThunkPrefix.size() + 1);
+
+        if (thunkPrefixEnd == std::string_view::npos)
+        {
+            return SetMalformed(result, "Failed to find the end of the thunk prefix.");
+        }
+
+        const char* const offsetStart = line.data() + ThunkPrefix.size();
+        const char* const offsetEnd = line.data() + thunkPrefixEnd;
+
+        auto [ptr, ec] = std::from_chars(offsetStart, offsetEnd, result.thunkOffset);
+
+        if (ec != std::errc() || ptr != offsetEnd)
+        {
+            return SetMalformed(result, "The thunk prefix does not contain a valid number.");
+        }
+
+        DEMANGLE_STATS_COUNT(ThunksStripped);
+
+        result.isThunk = true;
+        line.remove_prefix(thunkPrefixEnd + 1);
+    }
+
+    if (line.length() == 0)
+    {
+        return SetMalformed(result, "The line does not contain a mangled function name.");
+    }
+
+    result.mangledName = line;
+
+    return LinePreprocessStatus::Success;
+}
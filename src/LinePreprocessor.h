@@ -0,0 +1,50 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+enum class LinePreprocessStatus
+{
+    Success,
+    BlankLine,
+    Malformed
+};
+
+struct PreprocessedLine
+{
+    // The mangled function name with the virtual function prototype and thunk prefixes removed.
+    std::string_view mangledName;
+    // The <return type> and <parameters> fields of a virtual function prototype line.
+    std::string_view virtualReturnType;
+    std::string_view virtualParameters;
+    // The <unique number> field of a __thunk_<unique number>_ prefix.
+    uint32_t thunkOffset = 0;
+    bool isVirtualPrototype = false;
+    bool isThunk = false;
+    // A static string describing why the line could not be parsed.
+    const char* errorMessage = nullptr;
+};
+
+// Splits a line from the input file into its fields, the returned views point into the line.
+// Nothing is allocated and malformed lines are reported through the return value.
+LinePreprocessStatus PreprocessLine(std::string_view line, PreprocessedLine& result) noexcept;
@@ -0,0 +1,213 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "MemoryMappedFile.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static void MapFile(
+    const std::filesystem::path& path,
+    size_t minimumSize,
+    bool writable,
+    void*& fileHandle,
+    void*& mappingHandle,
+    uint8_t*& data,
+    size_t& size)
+{
+    fileHandle = CreateFileW(
+        path.c_str(),
+        writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        writable ? (FILE_SHARE_READ | FILE_SHARE_WRITE) : FILE_SHARE_READ,
+        nullptr,
+        writable ? OPEN_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open the file: " + path.string());
+    }
+
+    LARGE_INTEGER fileSize{};
+
+    if (!GetFileSizeEx(fileHandle, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+    {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Failed to get the file size: " + path.string());
+    }
+
+    // The file mapping extends the file to the mapping size.
+    size = std::max(static_cast<size_t>(fileSize.QuadPart), minimumSize);
+
+    if (size > 0)
+    {
+        // An empty file cannot be mapped.
+        const uint64_t mappingSize = writable ? size : 0;
+
+        mappingHandle = CreateFileMappingW(
+            fileHandle,
+            nullptr,
+            writable ? PAGE_READWRITE : PAGE_READONLY,
+            static_cast<DWORD>(mappingSize >> 32),
+            static_cast<DWORD>(mappingSize & 0xffffffff),
+            nullptr);
+
+        if (mappingHandle)
+        {
+            data = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+        }
+
+        if (!data)
+        {
+            if (mappingHandle)
+            {
+                CloseHandle(mappingHandle);
+            }
+            CloseHandle(fileHandle);
+            throw std::runtime_error("Failed to map the file: " + path.string());
+        }
+    }
+}
+
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path)
+    : data(nullptr), size(0), writable(false), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+    MapFile(path, 0, false, fileHandle, mappingHandle, data, size);
+}
+
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path, size_t minimumSize)
+    : data(nullptr), size(0), writable(true), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+    MapFile(path, minimumSize, true, fileHandle, mappingHandle, data, size);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (data)
+    {
+        UnmapViewOfFile(data);
+    }
+
+    if (mappingHandle)
+    {
+        CloseHandle(mappingHandle);
+    }
+
+    CloseHandle(fileHandle);
+}
+#else
+static void MapFile(const std::filesystem::path& path, size_t minimumSize, bool writable, uint8_t*& data, size_t& size)
+{
+    const int fd = writable ? open(path.c_str(), O_RDWR | O_CREAT, 0644) : open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+    {
+        throw std::runtime_error("Failed to open the file: " + path.string());
+    }
+
+    struct stat fileInfo {};
+
+    if (fstat(fd, &fileInfo) == -1)
+    {
+        close(fd);
+        throw std::runtime_error("Failed to get the file size: " + path.string());
+    }
+
+    size = static_cast<size_t>(fileInfo.st_size);
+
+    if (writable && size < minimumSize)
+    {
+        if (ftruncate(fd, static_cast<off_t>(minimumSize)) == -1)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to set the file size: " + path.string());
+        }
+
+        size = minimumSize;
+    }
+
+    if (size > 0)
+    {
+        // An empty file cannot be mapped.
+        void* mapping = writable
+            ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+            : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to map the file: " + path.string());
+        }
+
+        data = static_cast<uint8_t*>(mapping);
+    }
+
+    // The mapping stays valid after the file descriptor is closed.
+    close(fd);
+}
+
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path)
+    : data(nullptr), size(0), writable(false)
+{
+    MapFile(path, 0, false, data, size);
+}
+
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path, size_t minimumSize)
+    : data(nullptr), size(0), writable(true)
+{
+    MapFile(path, minimumSize, true, data, size);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (data)
+    {
+        munmap(data, size);
+    }
+}
+#endif // _WIN32
+
+const uint8_t* MemoryMappedFile::Data() const noexcept
+{
+    return data;
+}
+
+uint8_t* MemoryMappedFile::WritableData() const noexcept
+{
+    return writable ? data : nullptr;
+}
+
+size_t MemoryMappedFile::Size() const noexcept
+{
+    return size;
+}
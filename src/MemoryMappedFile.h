@@ -0,0 +1,54 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// A view of a file that is mapped into the address space of the process.
+class MemoryMappedFile
+{
+public:
+    // Maps an existing file for reading.
+    explicit MemoryMappedFile(const std::filesystem::path& path);
+    // Maps a file for reading and writing, the file is created or extended to at least the minimum size.
+    // The changes are shared with any other process that maps the same file.
+    MemoryMappedFile(const std::filesystem::path& path, size_t minimumSize);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    const uint8_t* Data() const noexcept;
+    // Returns nullptr if the file was mapped for reading only.
+    uint8_t* WritableData() const noexcept;
+    size_t Size() const noexcept;
+
+private:
+    uint8_t* data;
+    size_t size;
+    bool writable;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
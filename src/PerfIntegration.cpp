@@ -0,0 +1,202 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "PerfIntegration.h"
+#include "DemangleUtil.h"
+#include "TextFilter.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static constexpr size_t PerfScriptBlockSize = 4 * 1024 * 1024;
+
+namespace
+{
+    struct TextBlock
+    {
+        std::string input;
+        std::string output;
+    };
+
+    struct PendingBlock
+    {
+        std::shared_ptr<TextBlock> block;
+        std::future<void> done;
+    };
+
+    void WriteBlock(PendingBlock& pending, std::FILE* out)
+    {
+        {
+            TRACE_SPAN("wait for batch");
+            // Rethrows any exception from the worker thread.
+            pending.done.get();
+        }
+
+        TRACE_SPAN("write");
+        const std::string& output = pending.block->output;
+
+        if (std::fwrite(output.data(), 1, output.size(), out) != output.size())
+        {
+            throw std::runtime_error("Failed to write the output.");
+        }
+    }
+}
+
+void FilterPerfScript(std::FILE* in, std::FILE* out, DemangleCache& cache, ThreadPool& threadPool)
+{
+    // Limit the number of blocks that are in memory at the same time.
+    const size_t maxPendingBlocks = threadPool.GetThreadCount() * 2;
+    std::deque<PendingBlock> pendingBlocks;
+    std::string remainder;
+    bool endOfInput = false;
+
+    while (!endOfInput)
+    {
+        auto block = std::make_shared<TextBlock>();
+        std::string& input = block->input;
+
+        input.swap(remainder);
+        input.resize(PerfScriptBlockSize + input.size());
+
+        size_t size = input.size() - PerfScriptBlockSize;
+
+        TRACE_SPAN("read chunk");
+
+        while (size < input.size())
+        {
+            const size_t bytesRead = ReadAvailableInput(in, input.data() + size, input.size() - size);
+
+            if (bytesRead == 0)
+            {
+                endOfInput = true;
+                break;
+            }
+
+            size += bytesRead;
+        }
+
+        input.resize(size);
+
+        if (!endOfInput)
+        {
+            // The partial line at the end of the block is moved to the next block.
+            const size_t lastLineEnd = input.rfind('\n');
+
+            if (lastLineEnd != std::string::npos)
+            {
+                remainder.assign(input, lastLineEnd + 1);
+                input.resize(lastLineEnd + 1);
+            }
+        }
+
+        if (input.empty())
+        {
+            continue;
+        }
+
+        auto task = std::make_shared<std::packaged_task<void()>>([block, &cache]()
+        {
+            TRACE_SPAN("demangle batch");
+            block->output.reserve(block->input.size() + (block->input.size() / 2));
+            DemangleTextBlock(block->input, block->output, cache);
+            block->input = std::string();
+        });
+
+        pendingBlocks.push_back(PendingBlock{ block, task->get_future() });
+        threadPool.Submit([task]() { (*task)(); });
+
+        while (pendingBlocks.size() >= maxPendingBlocks)
+        {
+            WriteBlock(pendingBlocks.front(), out);
+            pendingBlocks.pop_front();
+        }
+    }
+
+    while (!pendingBlocks.empty())
+    {
+        WriteBlock(pendingBlocks.front(), out);
+        pendingBlocks.pop_front();
+    }
+
+    std::fflush(out);
+}
+
+void WritePerfMap(const AddressIndex& addressIndex, const std::filesystem::path& output, ThreadPool& threadPool)
+{
+    const size_t symbolCount = addressIndex.GetSymbolCount();
+    const size_t chunkCount = std::max<size_t>(1, std::min(symbolCount / 1024, threadPool.GetThreadCount() * 4));
+    const size_t chunkSize = (symbolCount + chunkCount - 1) / chunkCount;
+    std::vector<std::string> chunkOutput(chunkCount);
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        threadPool.Submit([&, chunk]()
+        {
+            const size_t start = chunk * chunkSize;
+            const size_t end = std::min(start + chunkSize, symbolCount);
+            std::string& text = chunkOutput[chunk];
+            std::string demangled;
+            char prefix[32]{};
+
+            for (size_t i = start; i < end; i++)
+            {
+                const uint32_t startAddress = addressIndex.GetStartAddress(i);
+                const std::string_view mangledName = addressIndex.GetMangledName(i);
+
+                std::snprintf(prefix, sizeof(prefix), "%x %x ", startAddress, addressIndex.GetEndAddress(i) - startAddress);
+                text.append(prefix);
+
+                // The names are null-terminated views into the ELF string table.
+                if (TryDemangle(mangledName.data(), DemangleFormat::FixedWidthTypes, demangled))
+                {
+                    text.append(demangled);
+                }
+                else
+                {
+                    text.append(mangledName);
+                }
+                text.push_back('\n');
+            }
+        });
+    }
+
+    threadPool.Wait();
+
+    std::ofstream out(output, std::ofstream::out | std::ofstream::binary);
+
+    for (const std::string& text : chunkOutput)
+    {
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("Failed to write the perf map file.");
+    }
+}
@@ -0,0 +1,36 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "AddressIndex.h"
+#include "DemangleCache.h"
+#include "ThreadPool.h"
+#include <cstdio>
+#include <filesystem>
+
+// Demangles the symbol names in perf script output.
+// The input is split into blocks of complete lines that are processed in parallel, the
+// blocks are written to the output in their original order.
+void FilterPerfScript(std::FILE* in, std::FILE* out, DemangleCache& cache, ThreadPool& threadPool);
+
+// Writes a perf map file (e.g. /tmp/perf-<pid>.map) with the demangled names of the symbols in the address index.
+// Each line uses the perf map format: <start address> <size> <symbol name>, the addresses are hexadecimal.
+void WritePerfMap(const AddressIndex& addressIndex, const std::filesystem::path& output, ThreadPool& threadPool);
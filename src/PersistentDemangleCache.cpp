@@ -0,0 +1,304 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "PersistentDemangleCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+namespace
+{
+    constexpr uint64_t FileSignature = 0x31434D44'4B334353; // SC3KDMC1
+    constexpr uint32_t FileFormatVersion = 1;
+    constexpr uint32_t SlotCount = 1 << 19;
+    constexpr uint32_t HeapCapacity = 48 * 1024 * 1024;
+    // The table is considered full at 75% of its slots, this keeps the probe sequences short.
+    constexpr uint32_t MaxEntryCount = (SlotCount / 4) * 3;
+
+    enum class FileState : uint32_t
+    {
+        Uninitialized = 0,
+        Initializing = 1,
+        Ready = 2
+    };
+
+    // A record stores the key and value lengths followed by the key and value bytes.
+    // A value length of 0xffffffff indicates that the demangler rejected the name.
+    struct RecordHeader
+    {
+        uint32_t options;
+        uint32_t keyLength;
+        uint32_t valueLength;
+    };
+
+    constexpr uint32_t RejectedValueLength = 0xffffffff;
+
+    // FNV-1a, seeded with the options so that each demangler configuration has separate entries.
+    uint64_t GetHash(std::string_view value, uint32_t options) noexcept
+    {
+        uint64_t hash = 14695981039346656037ULL ^ (static_cast<uint64_t>(options) * 1099511628211ULL);
+
+        for (const char c : value)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    // Reads the header of the record at the offset, returns false if the record does not fit in the used part of
+    // the heap, e.g. when the file is corrupt.
+    bool TryReadRecord(const uint8_t* heap, uint32_t heapUsed, uint32_t recordOffset, RecordHeader& record) noexcept
+    {
+        const uint64_t usedSize = std::min(heapUsed, HeapCapacity);
+
+        if (recordOffset < sizeof(uint32_t) || recordOffset + static_cast<uint64_t>(sizeof(RecordHeader)) > usedSize)
+        {
+            return false;
+        }
+
+        std::memcpy(&record, heap + recordOffset, sizeof(record));
+
+        const uint64_t valueLength = record.valueLength == RejectedValueLength ? 0 : record.valueLength;
+
+        return recordOffset + sizeof(RecordHeader) + static_cast<uint64_t>(record.keyLength) + valueLength <= usedSize;
+    }
+
+    // A slot packs the upper 32 bits of the hash with the heap offset of the record, zero is an empty slot.
+    constexpr uint64_t MakeSlot(uint64_t hash, uint32_t recordOffset) noexcept
+    {
+        return (hash & 0xffffffff00000000ULL) | recordOffset;
+    }
+}
+
+struct PersistentDemangleCache::FileHeader
+{
+    uint64_t signature;
+    uint32_t version;
+    uint32_t state;
+    uint32_t slotCount;
+    uint32_t heapCapacity;
+    uint32_t heapUsed;
+    uint32_t entryCount;
+};
+
+static constexpr size_t SlotsOffset = 64;
+static constexpr size_t HeapOffset = SlotsOffset + (static_cast<size_t>(SlotCount) * sizeof(uint64_t));
+static constexpr size_t CacheFileSize = HeapOffset + HeapCapacity;
+
+static const std::filesystem::path& CheckExistingCacheFile(const std::filesystem::path& path)
+{
+    // Refuse to extend an existing file that was not created as a cache, it may be another file
+    // that was passed by mistake.
+    std::error_code ec;
+    const uintmax_t existingSize = std::filesystem::file_size(path, ec);
+
+    if (!ec && existingSize != 0 && existingSize != CacheFileSize)
+    {
+        throw std::runtime_error("The file is not a compatible demangle cache, delete it to create a new cache: " + path.string());
+    }
+
+    return path;
+}
+
+PersistentDemangleCache::PersistentDemangleCache(const std::filesystem::path& path)
+    : file(CheckExistingCacheFile(path), CacheFileSize)
+{
+
+    FileHeader* const header = GetHeader();
+    std::atomic_ref<uint32_t> state(header->state);
+    uint32_t expected = static_cast<uint32_t>(FileState::Uninitialized);
+
+    if (header->signature == 0 && state.compare_exchange_strong(expected, static_cast<uint32_t>(FileState::Initializing)))
+    {
+        // A new file, the rest of the file is already zero-filled.
+        header->signature = FileSignature;
+        header->version = FileFormatVersion;
+        header->slotCount = SlotCount;
+        header->heapCapacity = HeapCapacity;
+        // Offset zero is reserved for the empty slots.
+        header->heapUsed = sizeof(uint32_t);
+        header->entryCount = 0;
+
+        state.store(static_cast<uint32_t>(FileState::Ready), std::memory_order_release);
+    }
+    else
+    {
+        // Wait for another process that is initializing the file.
+        for (int i = 0; i < 1000 && state.load(std::memory_order_acquire) != static_cast<uint32_t>(FileState::Ready); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    if (state.load(std::memory_order_acquire) != static_cast<uint32_t>(FileState::Ready)
+        || header->signature != FileSignature
+        || header->version != FileFormatVersion
+        || header->slotCount != SlotCount
+        || header->heapCapacity != HeapCapacity)
+    {
+        throw std::runtime_error("The demangle cache file is not compatible with this version, delete it to create a new cache: " + path.string());
+    }
+}
+
+PersistentDemangleCache::FileHeader* PersistentDemangleCache::GetHeader() const noexcept
+{
+    return reinterpret_cast<FileHeader*>(file.WritableData());
+}
+
+uint64_t* PersistentDemangleCache::GetSlots() const noexcept
+{
+    return reinterpret_cast<uint64_t*>(file.WritableData() + SlotsOffset);
+}
+
+uint8_t* PersistentDemangleCache::GetHeap() const noexcept
+{
+    return file.WritableData() + HeapOffset;
+}
+
+bool PersistentDemangleCache::TryGet(std::string_view mangledName, uint32_t options, std::string_view& result, bool& isDemangled) const noexcept
+{
+    const uint64_t hash = GetHash(mangledName, options);
+    uint64_t* const slots = GetSlots();
+    const uint8_t* const heap = GetHeap();
+    // A record is published after its heap space was reserved, so every published record is below heapUsed.
+    const uint32_t heapUsed = std::atomic_ref<uint32_t>(GetHeader()->heapUsed).load(std::memory_order_acquire);
+
+    for (uint32_t probe = 0, index = static_cast<uint32_t>(hash) & (SlotCount - 1); probe < SlotCount; probe++, index = (index + 1) & (SlotCount - 1))
+    {
+        const uint64_t slot = std::atomic_ref<uint64_t>(slots[index]).load(std::memory_order_acquire);
+
+        if (slot == 0)
+        {
+            return false;
+        }
+
+        if ((slot & 0xffffffff00000000ULL) != (hash & 0xffffffff00000000ULL))
+        {
+            continue;
+        }
+
+        const uint32_t recordOffset = static_cast<uint32_t>(slot);
+        RecordHeader record;
+
+        if (!TryReadRecord(heap, heapUsed, recordOffset, record))
+        {
+            continue;
+        }
+
+        const char* const key = reinterpret_cast<const char*>(heap + recordOffset + sizeof(RecordHeader));
+
+        if (record.options == options && std::string_view(key, record.keyLength) == mangledName)
+        {
+            isDemangled = record.valueLength != RejectedValueLength;
+            result = isDemangled ? std::string_view(key + record.keyLength, record.valueLength) : std::string_view();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PersistentDemangleCache::Add(std::string_view mangledName, uint32_t options, std::string_view demangledName) noexcept
+{
+    FileHeader* const header = GetHeader();
+    std::atomic_ref<uint32_t> entryCount(header->entryCount);
+
+    if (entryCount.load(std::memory_order_relaxed) >= MaxEntryCount)
+    {
+        return;
+    }
+
+    const uint64_t recordSize = sizeof(RecordHeader) + mangledName.size() + demangledName.size();
+
+    if (recordSize > HeapCapacity)
+    {
+        return;
+    }
+
+    // Reserve the heap space for the record, the space is lost if the record is not published.
+    // The heap usage never moves past the capacity, once the heap is full it stays full instead of wrapping
+    // around to the offsets of the live records.
+    const uint32_t alignedRecordSize = static_cast<uint32_t>((recordSize + 3) & ~3ULL);
+    std::atomic_ref<uint32_t> heapUsed(header->heapUsed);
+    uint32_t recordOffset = heapUsed.load(std::memory_order_relaxed);
+
+    do
+    {
+        if (recordOffset > HeapCapacity - alignedRecordSize)
+        {
+            return;
+        }
+    }
+    while (!heapUsed.compare_exchange_weak(recordOffset, recordOffset + alignedRecordSize, std::memory_order_relaxed));
+
+    uint8_t* const heap = GetHeap();
+    const RecordHeader record
+    {
+        options,
+        static_cast<uint32_t>(mangledName.size()),
+        demangledName.empty() ? RejectedValueLength : static_cast<uint32_t>(demangledName.size())
+    };
+
+    std::memcpy(heap + recordOffset, &record, sizeof(record));
+    std::memcpy(heap + recordOffset + sizeof(record), mangledName.data(), mangledName.size());
+    std::memcpy(heap + recordOffset + sizeof(record) + mangledName.size(), demangledName.data(), demangledName.size());
+
+    const uint64_t hash = GetHash(mangledName, options);
+    const uint64_t newSlot = MakeSlot(hash, recordOffset);
+    uint64_t* const slots = GetSlots();
+
+    for (uint32_t probe = 0, index = static_cast<uint32_t>(hash) & (SlotCount - 1); probe < SlotCount; probe++, index = (index + 1) & (SlotCount - 1))
+    {
+        std::atomic_ref<uint64_t> slot(slots[index]);
+        uint64_t expected = 0;
+
+        // The release ordering publishes the record data together with the slot.
+        if (slot.compare_exchange_strong(expected, newSlot, std::memory_order_release, std::memory_order_acquire))
+        {
+            entryCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if ((expected & 0xffffffff00000000ULL) == (hash & 0xffffffff00000000ULL))
+        {
+            RecordHeader existing;
+
+            if (!TryReadRecord(heap, heapUsed.load(std::memory_order_acquire), static_cast<uint32_t>(expected), existing))
+            {
+                continue;
+            }
+
+            const char* const key = reinterpret_cast<const char*>(heap + static_cast<uint32_t>(expected) + sizeof(RecordHeader));
+
+            if (existing.options == options && std::string_view(key, existing.keyLength) == mangledName)
+            {
+                // Another thread or process added the same name.
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "MemoryMappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// A demangler result cache that is stored in a memory mapped file, so it can be reused by later runs
+// and shared with other processes.
+// The file contains an open-addressing hash table and an append-only heap of key/value records.
+// Lookups do not take any locks, new entries are published with an atomic compare-exchange of their
+// hash table slot. The file has a fixed capacity, once it is full new results are no longer added.
+class PersistentDemangleCache
+{
+public:
+    explicit PersistentDemangleCache(const std::filesystem::path& path);
+
+    PersistentDemangleCache(const PersistentDemangleCache&) = delete;
+    PersistentDemangleCache& operator=(const PersistentDemangleCache&) = delete;
+
+    // Returns true if the name is in the cache. The isDemangled value is set to false when
+    // the demangler rejected the name, otherwise the demangled name is returned in the result.
+    // The result points into the memory mapped file.
+    bool TryGet(std::string_view mangledName, uint32_t options, std::string_view& result, bool& isDemangled) const noexcept;
+
+    // Adds a result to the cache, an empty demangled name indicates that the demangler rejected the name.
+    void Add(std::string_view mangledName, uint32_t options, std::string_view demangledName) noexcept;
+
+private:
+    struct FileHeader;
+
+    FileHeader* GetHeader() const noexcept;
+    uint64_t* GetSlots() const noexcept;
+    uint8_t* GetHeap() const noexcept;
+
+    MemoryMappedFile file;
+};
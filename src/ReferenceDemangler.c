@@ -0,0 +1,82 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+/* Builds reference/cplus-dem.c, the demangler as it was before any changes were
+   made to cplus-dem.c, with a prefix on every name that it exports.
+   reference/cplus-dem.c must not be edited, the corpus verification compares
+   cplus-dem.c to it.  */
+
+#define cplus_demangle egcs_cplus_demangle
+#define cplus_demangle_opname egcs_cplus_demangle_opname
+#define cplus_mangle_opname egcs_cplus_mangle_opname
+#define current_demangling_style egcs_current_demangling_style
+#define set_cplus_marker_for_demangling egcs_set_cplus_marker_for_demangling
+#define xmalloc egcs_xmalloc
+#define xrealloc egcs_xrealloc
+
+#include "reference/cplus-dem.c"
+#include "ReferenceDemangler.h"
+
+/* The original frees the previous argument of a thunk's method twice, once for
+   the method and again for the thunk, which crashes on every __thunk_ name.
+   The method is demangled on its own instead and the thunk text is added here,
+   the same way as gnu_special.  A thunk is demangled before anything else in
+   the name, so the method does not see any remembered types either way.  */
+
+char* reference_cplus_demangle(const char* mangled, int options)
+{
+  const char* method;
+  char* demangledMethod;
+  char* result;
+  char buf[50];
+  int style;
+  int delta;
+
+  style = options & DMGL_STYLE_MASK;
+
+  if (style == 0)
+    style = (int) current_demangling_style & DMGL_STYLE_MASK;
+
+  if ((style & (DMGL_AUTO | DMGL_GNU)) == 0 || strncmp (mangled, "__thunk_", 8) != 0)
+    return egcs_cplus_demangle (mangled, options);
+
+  method = mangled + 8;
+  delta = consume_count (&method);
+
+  /* The original skips the separator after the delta without checking for the
+     end of the name.  */
+  if (*method == '\0')
+    return NULL;
+
+  demangledMethod = egcs_cplus_demangle (method + 1, options);
+
+  if (demangledMethod == NULL)
+    return NULL;
+
+  sprintf (buf, "virtual function thunk (delta:%d) for ", -delta);
+
+  result = (char*) xmalloc (strlen (buf) + strlen (demangledMethod) + 1);
+  strcpy (result, buf);
+  strcat (result, demangledMethod);
+  free (demangledMethod);
+
+  return result;
+}
@@ -0,0 +1,32 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+/* The unmodified egcs-1.1.2 demangler from reference/cplus-dem.c, it is built
+   with prefixed names by ReferenceDemangler.c so that it can be linked next to
+   the demangler in cplus-dem.c.
+
+   It is only used to check the output of cplus-dem.c, the original code aborts,
+   overflows the stack or does not return for some malformed names.  The result
+   is allocated with malloc and must be released with free.  */
+
+char* reference_cplus_demangle(const char* mangled, int options);
@@ -0,0 +1,529 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "ScalingBenchmark.h"
+#include "ClassDump.h"
+#include "DemangleTree.h"
+#include "HardwareCounters.h"
+#include "LinePreprocessor.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static constexpr size_t ClassDumpLineCount = 4096;
+static constexpr size_t MinimumLineCount = 1000;
+// Smaller inputs are measured more than once to reduce the noise.
+static constexpr size_t RepeatedRunLineLimit = 1000000;
+static constexpr int RepeatCount = 3;
+static constexpr int ResultFormatVersion = 1;
+
+namespace
+{
+    struct ScalingResult
+    {
+        size_t lineCount;
+        size_t threadCount;
+        uint64_t byteCount;
+        double seconds;
+        // The peak of the whole benchmark process up to the end of this measurement, including the input that is
+        // kept in memory. It is not the peak of this measurement, every measurement after the largest one reports
+        // the same value.
+        uint64_t processPeakResidentBytes;
+        double parallelEfficiency;
+        // The hardware counters of the fastest run, summed over the calling thread and the worker threads.
+        HardwareCounterValues counters;
+
+        double LinesPerSecond() const
+        {
+            return static_cast<double>(lineCount) / seconds;
+        }
+
+        double MegabytesPerSecond() const
+        {
+            return static_cast<double>(byteCount) / (1024.0 * 1024.0) / seconds;
+        }
+    };
+
+    // Removes the temporary directory when the benchmark finishes or fails.
+    class TemporaryDirectory
+    {
+    public:
+        TemporaryDirectory()
+        {
+            std::random_device rd;
+            std::ostringstream name;
+            name << "SC3KLinuxDemangle-benchmark-" << std::hex << rd();
+
+            path = std::filesystem::temp_directory_path() / name.str();
+            std::filesystem::create_directories(path);
+        }
+
+        ~TemporaryDirectory()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+
+        TemporaryDirectory(const TemporaryDirectory&) = delete;
+        TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+        const std::filesystem::path& Path() const noexcept
+        {
+            return path;
+        }
+
+    private:
+        std::filesystem::path path;
+    };
+}
+
+// Returns the peak resident memory of the process since it started.
+static uint64_t GetProcessPeakResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+
+    return 0;
+#else
+    rusage usage{};
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    // Linux reports the size in kilobytes.
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Groups the input lines by the class name that DemangleClassDump strips from the demangled names,
+// a class dump must only contain the methods of one class.
+static std::vector<std::vector<std::string>> ReadClasses(const std::filesystem::path& input)
+{
+    std::ifstream in(input);
+
+    if (!in)
+    {
+        throw std::runtime_error("Failed to open the benchmark input file: " + input.string());
+    }
+
+    std::vector<std::vector<std::string>> classes;
+    std::unordered_map<std::string, size_t> classIndexes;
+    std::string line;
+    std::string mangledName;
+    PreprocessedLine preprocessed;
+
+    while (std::getline(in, line))
+    {
+        const LinePreprocessStatus status = PreprocessLine(line, preprocessed);
+
+        if (status == LinePreprocessStatus::BlankLine)
+        {
+            continue;
+        }
+
+        std::string className;
+
+        if (status != LinePreprocessStatus::Malformed)
+        {
+            mangledName.assign(preprocessed.mangledName);
+
+            // The lines are grouped by the scope of their tree, the same class name that the class dumps use.
+            std::pmr::monotonic_buffer_resource arena;
+            const DemangleTree* const tree = BuildDemangleTree(mangledName.c_str(), arena);
+            const size_t index = tree ? FindDemangleTreeScopeEnd(*tree, tree->text) : std::string::npos;
+
+            if (index != std::string::npos)
+            {
+                className = tree->text.substr(0, index);
+            }
+        }
+
+        const auto [it, inserted] = classIndexes.try_emplace(std::move(className), classes.size());
+
+        if (inserted)
+        {
+            classes.emplace_back();
+        }
+
+        classes[it->second].push_back(line);
+    }
+
+    if (classes.empty())
+    {
+        throw std::runtime_error("The benchmark input file does not contain any lines: " + input.string());
+    }
+
+    return classes;
+}
+
+// Writes class dumps with the given total line count, each class dump repeats the lines of one class.
+// Returns the total size in bytes.
+static uint64_t WriteClassDumps(
+    const std::vector<std::vector<std::string>>& classes,
+    size_t lineCount,
+    const std::filesystem::path& directory,
+    std::vector<std::filesystem::path>& classDumps)
+{
+    uint64_t byteCount = 0;
+    size_t writtenLineCount = 0;
+
+    classDumps.clear();
+
+    for (size_t fileIndex = 0; writtenLineCount < lineCount; fileIndex++)
+    {
+        const std::filesystem::path path = directory / ("class" + std::to_string(fileIndex) + ".txt");
+        std::ofstream out(path, std::ofstream::out | std::ofstream::binary);
+        const std::vector<std::string>& lines = classes[fileIndex % classes.size()];
+        const size_t fileLineCount = std::min(lineCount - writtenLineCount, ClassDumpLineCount);
+
+        for (size_t i = 0; i < fileLineCount; i++)
+        {
+            const std::string& line = lines[i % lines.size()];
+
+            out << line << '\n';
+            byteCount += line.size() + 1;
+        }
+
+        out.close();
+
+        if (out.fail())
+        {
+            throw std::runtime_error("Failed to write the benchmark input file: " + path.string());
+        }
+
+        writtenLineCount += fileLineCount;
+        classDumps.push_back(path);
+    }
+
+    return byteCount;
+}
+
+static double MeasureConversion(
+    const std::vector<std::filesystem::path>& classDumps,
+    const std::filesystem::path& outputDirectory,
+    size_t threadCount,
+    HardwareCounterValues& bestCounters)
+{
+    // The counters are opened before the thread pool is created so that they also count its worker threads.
+    HardwareCounters hardwareCounters(HardwareCounterScope::CallingThreadAndNewThreads);
+    ThreadPool threadPool(threadCount);
+    const int runCount = classDumps.size() * ClassDumpLineCount <= RepeatedRunLineLimit ? RepeatCount : 1;
+    double bestSeconds = 0;
+
+    for (int run = 0; run < runCount; run++)
+    {
+        hardwareCounters.Start();
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const std::filesystem::path& classDump : classDumps)
+        {
+            threadPool.Submit([&classDump, &outputDirectory]()
+            {
+                std::filesystem::path header = outputDirectory / classDump.filename();
+                header.replace_extension(".h");
+
+                DemangleInputFile(classDump, header);
+            });
+        }
+
+        threadPool.Wait();
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const HardwareCounterValues counters = hardwareCounters.Stop();
+
+        if (run == 0 || elapsed.count() < bestSeconds)
+        {
+            bestSeconds = elapsed.count();
+            bestCounters = counters;
+        }
+    }
+
+    return bestSeconds;
+}
+
+static std::vector<size_t> GetThreadCounts()
+{
+    const size_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts;
+
+    for (size_t threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+    {
+        threadCounts.push_back(threadCount);
+    }
+
+    threadCounts.push_back(maxThreadCount);
+
+    return threadCounts;
+}
+
+static void WriteResults(const std::filesystem::path& output, const std::filesystem::path& input, const std::vector<ScalingResult>& results)
+{
+    std::ofstream out(output, std::ofstream::out | std::ofstream::trunc);
+
+    if (!out)
+    {
+        throw std::runtime_error("Failed to open the benchmark output file: " + output.string());
+    }
+
+    // Only the file name is written, without the characters that would need to be escaped.
+    std::string inputName = input.filename().string();
+    inputName.erase(std::remove_if(inputName.begin(), inputName.end(), [](char c) { return c == '"' || c == '\\'; }), inputName.end());
+
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"version\": " << ResultFormatVersion << ",\n";
+    out << "  \"input\": \"" << inputName << "\",\n";
+    out << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const ScalingResult& result = results[i];
+
+        out << "    { \"lines\": " << result.lineCount
+            << ", \"threads\": " << result.threadCount
+            << ", \"bytes\": " << result.byteCount
+            << ", \"seconds\": " << result.seconds
+            << ", \"linesPerSecond\": " << result.LinesPerSecond()
+            << ", \"megabytesPerSecond\": " << result.MegabytesPerSecond()
+            << ", \"processPeakResidentBytes\": " << result.processPeakResidentBytes
+            << ", \"parallelEfficiency\": " << result.parallelEfficiency
+            << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("Failed to write the benchmark output file: " + output.string());
+    }
+}
+
+// Reads the line count, thread count and throughput of the results in a file written by WriteResults.
+static std::vector<ScalingResult> ReadBaseline(const std::filesystem::path& baseline)
+{
+    std::ifstream in(baseline);
+
+    if (!in)
+    {
+        throw std::runtime_error("Failed to open the benchmark baseline file: " + baseline.string());
+    }
+
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::regex resultPattern("\\{[^{}]*\\}");
+    const std::regex valuePattern("\"(lines|threads|seconds)\"\\s*:\\s*([0-9.eE+-]+)");
+    std::vector<ScalingResult> results;
+
+    for (auto it = std::sregex_iterator(text.begin(), text.end(), resultPattern); it != std::sregex_iterator(); ++it)
+    {
+        const std::string object = it->str();
+        ScalingResult result{};
+
+        for (auto value = std::sregex_iterator(object.begin(), object.end(), valuePattern); value != std::sregex_iterator(); ++value)
+        {
+            const std::string name = (*value)[1].str();
+            const std::string number = (*value)[2].str();
+
+            if (name == "lines")
+            {
+                result.lineCount = std::stoull(number);
+            }
+            else if (name == "threads")
+            {
+                result.threadCount = std::stoull(number);
+            }
+            else
+            {
+                result.seconds = std::stod(number);
+            }
+        }
+
+        if (result.lineCount == 0 || result.threadCount == 0 || result.seconds <= 0)
+        {
+            throw std::runtime_error("The benchmark baseline file contains an invalid result: " + baseline.string());
+        }
+
+        results.push_back(result);
+    }
+
+    if (results.empty())
+    {
+        throw std::runtime_error("The benchmark baseline file does not contain any results: " + baseline.string());
+    }
+
+    return results;
+}
+
+static bool CompareToBaseline(const std::vector<ScalingResult>& results, const std::vector<ScalingResult>& baseline, double tolerance)
+{
+    bool passed = true;
+    size_t comparedCount = 0;
+
+    for (const ScalingResult& result : results)
+    {
+        const auto it = std::find_if(baseline.begin(), baseline.end(), [&](const ScalingResult& b)
+        {
+            return b.lineCount == result.lineCount && b.threadCount == result.threadCount;
+        });
+
+        if (it == baseline.end())
+        {
+            continue;
+        }
+
+        comparedCount++;
+
+        const double change = result.LinesPerSecond() / it->LinesPerSecond() - 1.0;
+        const bool regressed = change < -tolerance;
+
+        std::cout << result.lineCount << " lines, " << result.threadCount << " thread(s): "
+                  << std::showpos << (change * 100.0) << std::noshowpos << "% lines/s"
+                  << (regressed ? " REGRESSION" : "") << std::endl;
+
+        if (regressed)
+        {
+            passed = false;
+        }
+    }
+
+    // A baseline that was measured with other line or thread counts cannot detect a regression.
+    if (comparedCount == 0)
+    {
+        std::cout << "None of the results has a baseline result with the same line and thread count." << std::endl;
+        return false;
+    }
+
+    return passed;
+}
+
+bool RunScalingBenchmark(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    const std::filesystem::path& baseline,
+    const ScalingBenchmarkOptions& options)
+{
+    const std::vector<std::vector<std::string>> classes = ReadClasses(input);
+    // Read the baseline first so that an invalid file is reported before the benchmark runs.
+    const std::vector<ScalingResult> baselineResults = baseline.empty() ? std::vector<ScalingResult>() : ReadBaseline(baseline);
+    const std::vector<size_t> threadCounts = GetThreadCounts();
+
+    TemporaryDirectory directory;
+    const std::filesystem::path inputDirectory = directory.Path() / "input";
+    const std::filesystem::path outputDirectory = directory.Path() / "output";
+    std::filesystem::create_directories(inputDirectory);
+    std::filesystem::create_directories(outputDirectory);
+
+    std::vector<ScalingResult> results;
+    std::vector<std::filesystem::path> classDumps;
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    if (const HardwareCounters hardwareCounters; !hardwareCounters.IsAvailable())
+    {
+        std::cout << "Hardware counters are not available, " << hardwareCounters.GetUnavailableReason() << std::endl;
+    }
+
+    for (size_t lineCount = MinimumLineCount; lineCount <= options.maxLineCount; lineCount *= 10)
+    {
+        const uint64_t byteCount = WriteClassDumps(classes, lineCount, inputDirectory, classDumps);
+        double singleThreadSeconds = 0;
+
+        for (const size_t threadCount : threadCounts)
+        {
+            HardwareCounterValues counters;
+            const double seconds = MeasureConversion(classDumps, outputDirectory, threadCount, counters);
+
+            if (threadCount == 1)
+            {
+                singleThreadSeconds = seconds;
+            }
+
+            const ScalingResult result
+            {
+                lineCount,
+                threadCount,
+                byteCount,
+                seconds,
+                GetProcessPeakResidentBytes(),
+                singleThreadSeconds / (seconds * static_cast<double>(threadCount)),
+                counters
+            };
+
+            std::cout << lineCount << " lines, " << threadCount << " thread(s): "
+                      << result.LinesPerSecond() << " lines/s, " << result.MegabytesPerSecond() << " MB/s, "
+                      << (result.parallelEfficiency * 100.0) << "% parallel efficiency, "
+                      << (result.processPeakResidentBytes / (1024 * 1024)) << " MB process peak RSS" << std::endl;
+            WriteHardwareCounters(std::cout, result.counters, static_cast<double>(lineCount), "line");
+
+            results.push_back(result);
+        }
+
+        std::filesystem::remove_all(inputDirectory);
+        std::filesystem::remove_all(outputDirectory);
+        std::filesystem::create_directories(inputDirectory);
+        std::filesystem::create_directories(outputDirectory);
+    }
+
+    WriteResults(output, input, results);
+
+    if (baseline.empty())
+    {
+        return true;
+    }
+
+    return CompareToBaseline(results, baselineResults, options.regressionTolerance);
+}
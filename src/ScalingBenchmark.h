@@ -0,0 +1,44 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <filesystem>
+#include <vector>
+
+struct ScalingBenchmarkOptions
+{
+    // The input sizes are the powers of 10 from 1000 lines up to this line count.
+    size_t maxLineCount = 1000000;
+    // The allowed throughput loss compared to the baseline, as a fraction of the baseline throughput.
+    double regressionTolerance = 0.1;
+};
+
+// Measures the throughput of DemangleInputFile for each combination of input size and thread count,
+// the thread counts are the powers of 2 up to the number of hardware threads.
+// The inputs are class dumps of up to 4096 lines in a temporary directory, each repeats the lines of one
+// class from the input file. The class dumps are converted in parallel.
+// The results are written to the output file as JSON. When a baseline file written by a previous
+// run is provided, the function returns false if the throughput of any measurement regressed.
+bool RunScalingBenchmark(
+    const std::filesystem::path& input,
+    const std::filesystem::path& output,
+    const std::filesystem::path& baseline,
+    const ScalingBenchmarkOptions& options);
@@ -0,0 +1,151 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "StreamFilter.h"
+#include "DemangleStats.h"
+#include "DemangleUtil.h"
+#include "LinePreprocessor.h"
+#include "Tracing.h"
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+static constexpr size_t OutputBufferSize = 64 * 1024;
+
+// Reads the next line from the input, timed as part of the input phase.
+static bool ReadInputLine(std::istream& in, std::string& line)
+{
+    DEMANGLE_STATS_TIMER(ReadInput);
+
+    if (!std::getline(in, line))
+    {
+        return false;
+    }
+
+    DEMANGLE_STATS_COUNT(LinesRead);
+    return true;
+}
+
+#ifdef _WIN32
+// Returns true if a read of the standard input would return without waiting.
+static bool IsStandardInputReady()
+{
+    const HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+
+    switch (GetFileType(input))
+    {
+    case FILE_TYPE_PIPE:
+    {
+        DWORD bytesAvailable = 0;
+
+        // A pipe whose writer has closed it fails, the read returns the end of the input without waiting.
+        return !PeekNamedPipe(input, nullptr, 0, nullptr, &bytesAvailable, nullptr) || bytesAvailable > 0;
+    }
+    case FILE_TYPE_CHAR:
+        // The console handle is signaled when it has unread input events.
+        return WaitForSingleObject(input, 0) == WAIT_OBJECT_0;
+    default:
+        // A read from a file does not wait.
+        return true;
+    }
+}
+#else
+// Returns true if a read of the standard input would return without waiting.
+static bool IsStandardInputReady()
+{
+    pollfd input{ STDIN_FILENO, POLLIN, 0 };
+
+    // The end of the input and errors also make a read return without waiting.
+    return poll(&input, 1, 0) != 0;
+}
+#endif
+
+// Returns true if the next read of the input would have to wait for more data.
+// The stream buffer of std::cin does not report the data that the operating system holds for it,
+// e.g. it always reports none with the MSVC runtime, so the standard input itself is checked.
+static bool IsInputIdle(std::istream& in)
+{
+    if (in.rdbuf()->in_avail() > 0)
+    {
+        return false;
+    }
+
+    return &in != &std::cin || !IsStandardInputReady();
+}
+
+static void FlushOutput(std::string& buffer, std::FILE* out)
+{
+    DEMANGLE_STATS_TIMER(WriteOutput);
+    TRACE_SPAN("write");
+
+    if (buffer.size() > 0)
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), out);
+        buffer.clear();
+    }
+
+    std::fflush(out);
+}
+
+void DemangleStream(std::istream& in, std::FILE* out)
+{
+    std::string line;
+    std::string mangledName;
+    std::string outputBuffer;
+    PreprocessedLine preprocessed;
+
+    outputBuffer.reserve(OutputBufferSize + 4096);
+
+    while (ReadInputLine(in, line))
+    {
+        const LinePreprocessStatus status = PreprocessLine(line, preprocessed);
+
+        if (status == LinePreprocessStatus::Success)
+        {
+            // The demangler requires a null-terminated string.
+            mangledName.assign(preprocessed.mangledName);
+
+            outputBuffer.append(GetDemangledLine(mangledName.c_str()));
+        }
+        else
+        {
+            // Blank and malformed lines are passed through unchanged.
+            outputBuffer.append(line);
+        }
+        outputBuffer.push_back('\n');
+
+        // Flush when the buffer is full, or when the next read would have to wait for more input.
+        if (outputBuffer.size() >= OutputBufferSize || IsInputIdle(in))
+        {
+            FlushOutput(outputBuffer, out);
+        }
+    }
+
+    FlushOutput(outputBuffer, out);
+}
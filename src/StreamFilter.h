@@ -0,0 +1,31 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdio>
+#include <istream>
+
+// Reads one mangled function name per line from the input stream and writes the
+// demangled names to the output file as they are produced.
+// The output is buffered and flushed when the buffer fills up or the input stream has no more
+// data available, so a pipeline gets the first results without waiting for the end of the input.
+// For std::cin the operating system is asked whether the standard input has more data.
+void DemangleStream(std::istream& in, std::FILE* out);
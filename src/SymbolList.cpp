@@ -0,0 +1,116 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "SymbolList.h"
+#include "LinePreprocessor.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+bool IsElfFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
+    char signature[4]{};
+
+    file.read(signature, sizeof(signature));
+
+    return file.good() && signature[0] == 0x7f && signature[1] == 'E' && signature[2] == 'L' && signature[3] == 'F';
+}
+
+SymbolList::SymbolList(const std::filesystem::path& path)
+    : elfReader(), textFileData(), names()
+{
+    if (IsElfFile(path))
+    {
+        elfReader = std::make_unique<ElfSymbolReader>(path);
+
+        const std::vector<ElfSymbol>& symbols = elfReader->GetSymbols();
+        names.reserve(symbols.size());
+
+        for (const ElfSymbol& symbol : symbols)
+        {
+            if (symbol.type == ElfSymbolType::Function || symbol.type == ElfSymbolType::Object || symbol.type == ElfSymbolType::NoType)
+            {
+                names.push_back(symbol.name);
+            }
+        }
+    }
+    else
+    {
+        std::ifstream in(path, std::ifstream::in | std::ifstream::binary);
+
+        if (!in)
+        {
+            throw std::runtime_error("Failed to open the file: " + path.string());
+        }
+
+        textFileData.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+        PreprocessedLine preprocessed;
+        char* const data = textFileData.data();
+        const size_t size = textFileData.size();
+        size_t lineStart = 0;
+
+        while (lineStart < size)
+        {
+            size_t lineEnd = textFileData.find('\n', lineStart);
+
+            if (lineEnd == std::string::npos)
+            {
+                lineEnd = size;
+            }
+
+            size_t lineLength = lineEnd - lineStart;
+
+            if (lineLength > 0 && data[lineStart + lineLength - 1] == '\r')
+            {
+                lineLength--;
+            }
+
+            if (PreprocessLine(std::string_view(data + lineStart, lineLength), preprocessed) == LinePreprocessStatus::Success)
+            {
+                // Terminate the mangled name in place, this overwrites the first character after
+                // the name, which is part of the line that has already been parsed.
+                const size_t nameOffset = static_cast<size_t>(preprocessed.mangledName.data() - data);
+                const size_t nameEnd = nameOffset + preprocessed.mangledName.size();
+
+                if (nameEnd < size)
+                {
+                    data[nameEnd] = '\0';
+                }
+
+                names.push_back(std::string_view(data + nameOffset, preprocessed.mangledName.size()));
+            }
+
+            lineStart = lineEnd + 1;
+        }
+    }
+}
+
+const std::vector<std::string_view>& SymbolList::GetNames() const noexcept
+{
+    return names;
+}
+
+const ElfSymbolReader* SymbolList::GetElfSymbolReader() const noexcept
+{
+    return elfReader.get();
+}
@@ -0,0 +1,53 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "ElfSymbolReader.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A list of mangled names that is read from an ELF file or from a text file with one name per line.
+// The names are null-terminated views into the file data, so they can be passed to the
+// demangler without copying them.
+class SymbolList
+{
+public:
+    explicit SymbolList(const std::filesystem::path& path);
+
+    SymbolList(const SymbolList&) = delete;
+    SymbolList& operator=(const SymbolList&) = delete;
+
+    const std::vector<std::string_view>& GetNames() const noexcept;
+
+    // The ELF symbol reader, or nullptr when the names were read from a text file.
+    const ElfSymbolReader* GetElfSymbolReader() const noexcept;
+
+private:
+    std::unique_ptr<ElfSymbolReader> elfReader;
+    std::string textFileData;
+    std::vector<std::string_view> names;
+};
+
+// Returns true if the file starts with the ELF signature.
+bool IsElfFile(const std::filesystem::path& path);
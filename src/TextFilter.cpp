@@ -0,0 +1,316 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "TextFilter.h"
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXT_FILTER_USE_SSE2 1
+#endif
+
+static constexpr size_t ReadBufferSize = 1024 * 1024;
+
+// The characters that the c++filt label scanner treats as part of an identifier.
+static constexpr std::array<bool, 256> IdentifierCharacterTable = []()
+{
+    std::array<bool, 256> table{};
+
+    for (int i = '0'; i <= '9'; i++)
+    {
+        table[i] = true;
+    }
+
+    for (int i = 'A'; i <= 'Z'; i++)
+    {
+        table[i] = true;
+        table[i + ('a' - 'A')] = true;
+    }
+
+    table['_'] = true;
+    table['$'] = true;
+    table['.'] = true;
+
+    return table;
+}();
+
+static inline bool IsIdentifierCharacter(char c) noexcept
+{
+    return IdentifierCharacterTable[static_cast<unsigned char>(c)];
+}
+
+#ifdef TEXT_FILTER_USE_SSE2
+// Returns a bit mask with a bit set for each of the 16 characters that are identifier characters.
+static inline uint32_t GetIdentifierMask(const char* p) noexcept
+{
+    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+    // Clearing bit 5 maps the lower case letters onto the upper case letters.
+    const __m128i upper = _mm_and_si128(chars, _mm_set1_epi8(static_cast<char>(0xDF)));
+    const __m128i isLetter = _mm_and_si128(
+        _mm_cmpgt_epi8(upper, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(upper, _mm_set1_epi8('Z' + 1)));
+    const __m128i isDigit = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    const __m128i isSymbol = _mm_or_si128(
+        _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')),
+        _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('$')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('.'))));
+
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isLetter, isDigit), isSymbol)));
+}
+#endif // TEXT_FILTER_USE_SSE2
+
+// Returns a pointer to the first character in the range that is (or is not) an identifier character.
+template <bool identifier> static const char* FindCharacter(const char* p, const char* const end) noexcept
+{
+#ifdef TEXT_FILTER_USE_SSE2
+    while ((end - p) >= 16)
+    {
+        uint32_t mask = GetIdentifierMask(p);
+
+        if constexpr (!identifier)
+        {
+            mask = ~mask & 0xFFFF;
+        }
+
+        if (mask != 0)
+        {
+            return p + std::countr_zero(mask);
+        }
+
+        p += 16;
+    }
+#endif // TEXT_FILTER_USE_SSE2
+
+    while (p < end && IsIdentifierCharacter(*p) != identifier)
+    {
+        p++;
+    }
+
+    return p;
+}
+
+// Parses a hexadecimal address in the 0x<digits> form.
+static bool TryParseAddress(std::string_view identifier, uint32_t& address) noexcept
+{
+    if (identifier.size() < 3 || identifier.size() > 10 || identifier[0] != '0' || (identifier[1] != 'x' && identifier[1] != 'X'))
+    {
+        return false;
+    }
+
+    const char* const end = identifier.data() + identifier.size();
+    auto [ptr, ec] = std::from_chars(identifier.data() + 2, end, address, 16);
+
+    return ec == std::errc() && ptr == end;
+}
+
+static void AppendAddressSymbol(uint32_t address, std::string& output, const AddressIndex& addressIndex)
+{
+    const size_t index = addressIndex.Find(address);
+
+    if (index != AddressIndex::NotFound)
+    {
+        char offset[16]{};
+        std::snprintf(offset, sizeof(offset), "+0x%x>", address - addressIndex.GetStartAddress(index));
+
+        output.append(" <");
+        output.append(addressIndex.GetDemangledName(index));
+        output.append(offset);
+    }
+}
+
+// The previous character is the input character before the identifier, or '\0' at the start of the input.
+static void AppendIdentifier(
+    std::string_view identifier,
+    char previousCharacter,
+    std::string& output,
+    DemangleCache& cache,
+    const AddressIndex* addressIndex,
+    std::string& demangled)
+{
+    // A leading '.' is not part of the mangled name, it is written back to the output if the name is demangled.
+    const size_t skipFirst = identifier[0] == '.' ? 1 : 0;
+    const std::string_view name = identifier.substr(skipFirst);
+    uint32_t address = 0;
+
+    if (IsPossibleMangledName(name) && cache.TryDemangle(name, demangled))
+    {
+        output.append(identifier.substr(0, skipFirst));
+        output.append(demangled);
+    }
+    else if (addressIndex
+        && TryParseAddress(identifier, address)
+        && previousCharacter != '+'
+        && previousCharacter != '-')
+    {
+        // Hexadecimal values that follow a '+' or '-' are offsets, e.g. the +0x14 in Foo__3Bar+0x14.
+        output.append(identifier);
+        AppendAddressSymbol(address, output, *addressIndex);
+    }
+    else
+    {
+        output.append(identifier);
+    }
+}
+
+// Processes the text and returns the number of characters that were consumed.
+// If more input follows and the text ends inside an identifier, that identifier is not consumed.
+// The previous character is the last character that was consumed before the text, or '\0' if there is none.
+static size_t ProcessText(
+    std::string_view text,
+    char previousCharacter,
+    bool moreInputFollows,
+    std::string& output,
+    DemangleCache& cache,
+    const AddressIndex* addressIndex,
+    std::string& demangled)
+{
+    const char* const start = text.data();
+    const char* const end = start + text.size();
+    const char* p = start;
+
+    while (p < end)
+    {
+        const char* identifierStart = FindCharacter<true>(p, end);
+
+        output.append(p, identifierStart);
+
+        if (identifierStart == end)
+        {
+            return text.size();
+        }
+
+        const char* identifierEnd = FindCharacter<false>(identifierStart, end);
+
+        if (identifierEnd == end && moreInputFollows)
+        {
+            // The identifier may continue in the next read.
+            return static_cast<size_t>(identifierStart - start);
+        }
+
+        AppendIdentifier(
+            std::string_view(identifierStart, identifierEnd - identifierStart),
+            identifierStart > start ? identifierStart[-1] : previousCharacter,
+            output,
+            cache,
+            addressIndex,
+            demangled);
+        p = identifierEnd;
+    }
+
+    return text.size();
+}
+
+size_t ReadAvailableInput(std::FILE* in, char* buffer, size_t count)
+{
+#ifdef _WIN32
+    int bytesRead;
+#else
+    ssize_t bytesRead;
+#endif
+
+    // A read that is interrupted by a signal before any data arrives is retried.
+    do
+    {
+#ifdef _WIN32
+        bytesRead = _read(_fileno(in), buffer, static_cast<unsigned int>(count));
+#else
+        bytesRead = read(fileno(in), buffer, count);
+#endif
+    } while (bytesRead < 0 && errno == EINTR);
+
+    if (bytesRead < 0)
+    {
+        throw std::runtime_error("Failed to read the input.");
+    }
+
+    return static_cast<size_t>(bytesRead);
+}
+
+void DemangleTextBlock(std::string_view text, std::string& output, DemangleCache& cache, const AddressIndex* addressIndex)
+{
+    std::string demangled;
+
+    ProcessText(text, '\0', false, output, cache, addressIndex, demangled);
+}
+
+void DemangleText(std::FILE* in, std::FILE* out, DemangleCache& cache, const AddressIndex* addressIndex)
+{
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(ReadBufferSize);
+    std::string output;
+    std::string demangled;
+    size_t bufferedBytes = 0;
+    // The output is written after every read, the offset check for an address at the start of
+    // the buffer uses the last character of the previous read.
+    char previousCharacter = '\0';
+    bool endOfInput = false;
+
+    output.reserve(ReadBufferSize * 2);
+
+    while (!endOfInput)
+    {
+        const size_t bytesRead = ReadAvailableInput(in, buffer.get() + bufferedBytes, ReadBufferSize - bufferedBytes);
+
+        endOfInput = bytesRead == 0;
+        bufferedBytes += bytesRead;
+
+        const std::string_view text(buffer.get(), bufferedBytes);
+        size_t consumed = ProcessText(text, previousCharacter, !endOfInput, output, cache, addressIndex, demangled);
+
+        if (consumed == 0 && bufferedBytes == ReadBufferSize)
+        {
+            // An identifier that fills the whole buffer is processed as-is.
+            consumed = ProcessText(text, previousCharacter, false, output, cache, addressIndex, demangled);
+        }
+
+        if (consumed > 0)
+        {
+            previousCharacter = text[consumed - 1];
+        }
+
+        // Move any incomplete identifier to the start of the buffer.
+        bufferedBytes -= consumed;
+        std::memmove(buffer.get(), buffer.get() + consumed, bufferedBytes);
+
+        if (output.size() > 0)
+        {
+            std::fwrite(output.data(), 1, output.size(), out);
+            std::fflush(out);
+            output.clear();
+        }
+    }
+}
@@ -0,0 +1,42 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include "AddressIndex.h"
+#include "DemangleCache.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Copies the text from the input file to the output file, replacing any
+// GNU v2 mangled names that it contains with their demangled form.
+// This is the equivalent of the c++filt stdin mode, e.g. to demangle a crash log or perf output.
+// When an address index is provided, hexadecimal addresses are followed by the symbol that contains them.
+void DemangleText(std::FILE* in, std::FILE* out, DemangleCache& cache, const AddressIndex* addressIndex = nullptr);
+
+// Processes a block of text that does not end inside an identifier, e.g. a block of complete lines.
+// The result is appended to the output.
+void DemangleTextBlock(std::string_view text, std::string& output, DemangleCache& cache, const AddressIndex* addressIndex = nullptr);
+
+// Reads the data that is currently available, a pipe does not block until the whole buffer is filled.
+// Returns zero at the end of the input.
+size_t ReadAvailableInput(std::FILE* in, char* buffer, size_t count);
@@ -0,0 +1,151 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "ThreadPool.h"
+#include "Tracing.h"
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : threads(), tasks(), mutex(), taskAvailable(), idle(), firstException(), activeTaskCount(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+
+        if (threadCount == 0)
+        {
+            threadCount = 1;
+        }
+    }
+
+    threads.reserve(threadCount);
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(&ThreadPool::WorkerThread, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    taskAvailable.notify_all();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    if (IsTracingEnabled())
+    {
+        // Record the time that the task waits in the queue.
+        task = [innerTask = std::move(task), submitted = GetTraceTimestamp()]()
+        {
+            AddTraceAsyncSpan("queue wait", submitted, GetTraceTimestamp());
+            innerTask();
+        };
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    TRACE_SPAN("wait for tasks");
+    std::unique_lock<std::mutex> lock(mutex);
+
+    idle.wait(lock, [this] { return tasks.empty() && activeTaskCount == 0; });
+
+    if (firstException)
+    {
+        std::exception_ptr exception = firstException;
+        firstException = nullptr;
+
+        std::rethrow_exception(exception);
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const noexcept
+{
+    return threads.size();
+}
+
+void ThreadPool::WorkerThread()
+{
+    SetTraceThreadName("worker");
+
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            TRACE_SPAN("idle");
+            std::unique_lock<std::mutex> lock(mutex);
+
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+            if (tasks.empty())
+            {
+                // The pool is being destroyed and there is no remaining work.
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            activeTaskCount++;
+        }
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!firstException)
+            {
+                firstException = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeTaskCount--;
+
+            if (tasks.empty() && activeTaskCount == 0)
+            {
+                idle.notify_all();
+            }
+        }
+    }
+}
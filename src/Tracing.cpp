@@ -0,0 +1,288 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "Tracing.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+static constexpr size_t TraceChunkEventCount = 4096;
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char* name;
+        int64_t start;
+        int64_t end;
+        bool isAsync;
+    };
+
+    // The events are stored in a linked list of fixed-size chunks, so the owning thread never moves an
+    // event that another thread could be reading. A chunk publishes its count with a release store.
+    struct TraceChunk
+    {
+        std::array<TraceEvent, TraceChunkEventCount> events;
+        std::atomic<size_t> count{};
+        std::atomic<TraceChunk*> next{};
+    };
+
+    struct ThreadTraceBuffer
+    {
+        uint32_t threadId = 0;
+        std::atomic<const char*> name{};
+        std::unique_ptr<TraceChunk> first = std::make_unique<TraceChunk>();
+        TraceChunk* last = first.get();
+
+        ~ThreadTraceBuffer()
+        {
+            // Free the chunks iteratively, a recursive destructor could overflow the stack of a long trace.
+            TraceChunk* chunk = first.release();
+
+            while (chunk)
+            {
+                TraceChunk* next = chunk->next.load(std::memory_order_relaxed);
+                delete chunk;
+                chunk = next;
+            }
+        }
+
+        // The spans are recorded from noexcept functions, an event is dropped when there is no memory
+        // for a new chunk instead of ending the process.
+        void Add(const TraceEvent& event) noexcept
+        {
+            size_t count = last->count.load(std::memory_order_relaxed);
+
+            if (count == TraceChunkEventCount)
+            {
+                TraceChunk* chunk = new (std::nothrow) TraceChunk();
+
+                if (!chunk)
+                {
+                    return;
+                }
+
+                last->next.store(chunk, std::memory_order_release);
+                last = chunk;
+                count = 0;
+            }
+
+            last->events[count] = event;
+            last->count.store(count + 1, std::memory_order_release);
+        }
+    };
+
+    struct TraceRegistry
+    {
+        std::mutex mutex;
+        // The buffers are kept after their threads exit, the trace is written at the end of the run.
+        std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+    };
+
+    TraceRegistry& GetRegistry()
+    {
+        // Never destroyed, the threads may exit after the static destructors have run.
+        static TraceRegistry* const registry = new TraceRegistry();
+        return *registry;
+    }
+
+    // Returns nullptr if the buffer of the thread could not be created, the thread's events are then dropped.
+    ThreadTraceBuffer* GetThreadBuffer() noexcept
+    {
+        try
+        {
+            // The registry only locks its mutex the first time that a thread records a span.
+            // A failed initialization is retried by the next call.
+            thread_local const std::shared_ptr<ThreadTraceBuffer> buffer = []()
+            {
+                auto newBuffer = std::make_shared<ThreadTraceBuffer>();
+                TraceRegistry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+
+                newBuffer->threadId = static_cast<uint32_t>(registry.buffers.size() + 1);
+                registry.buffers.push_back(newBuffer);
+
+                return newBuffer;
+            }();
+
+            return buffer.get();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+}
+
+static bool tracingEnabled = false;
+static std::chrono::steady_clock::time_point traceStart;
+
+void EnableTracing() noexcept
+{
+    traceStart = std::chrono::steady_clock::now();
+    tracingEnabled = true;
+}
+
+bool IsTracingEnabled() noexcept
+{
+    return tracingEnabled;
+}
+
+int64_t GetTraceTimestamp() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceStart).count();
+}
+
+void SetTraceThreadName(const char* name) noexcept
+{
+    if (tracingEnabled)
+    {
+        ThreadTraceBuffer* const buffer = GetThreadBuffer();
+
+        if (buffer)
+        {
+            buffer->name.store(name, std::memory_order_relaxed);
+        }
+    }
+}
+
+void AddTraceSpan(const char* name, int64_t start, int64_t end) noexcept
+{
+    if (tracingEnabled)
+    {
+        ThreadTraceBuffer* const buffer = GetThreadBuffer();
+
+        if (buffer)
+        {
+            buffer->Add(TraceEvent{ name, start, end, false });
+        }
+    }
+}
+
+void AddTraceAsyncSpan(const char* name, int64_t start, int64_t end) noexcept
+{
+    if (tracingEnabled)
+    {
+        ThreadTraceBuffer* const buffer = GetThreadBuffer();
+
+        if (buffer)
+        {
+            buffer->Add(TraceEvent{ name, start, end, true });
+        }
+    }
+}
+
+TraceSpan::TraceSpan(const char* name) noexcept : name(name), start(tracingEnabled ? GetTraceTimestamp() : 0)
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (tracingEnabled)
+    {
+        AddTraceSpan(name, start, GetTraceTimestamp());
+    }
+}
+
+// The trace event timestamps are in microseconds.
+static void WriteMicroseconds(std::ostream& out, int64_t nanoseconds)
+{
+    out << (nanoseconds / 1000) << '.' << static_cast<char>('0' + (nanoseconds / 100) % 10)
+        << static_cast<char>('0' + (nanoseconds / 10) % 10) << static_cast<char>('0' + nanoseconds % 10);
+}
+
+void WriteTrace(const std::filesystem::path& path)
+{
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+
+    {
+        TraceRegistry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        buffers = registry.buffers;
+    }
+
+    std::ofstream out(path, std::ofstream::out | std::ofstream::trunc);
+
+    if (!out)
+    {
+        throw std::runtime_error("Failed to open the trace file: " + path.string());
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"SC3KLinuxDemangle\"}}";
+
+    uint64_t asyncId = 0;
+
+    for (const auto& buffer : buffers)
+    {
+        const char* const name = buffer->name.load(std::memory_order_relaxed);
+
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":\"" << (name ? name : "thread") << ' ' << buffer->threadId << "\"}}";
+
+        for (const TraceChunk* chunk = buffer->first.get(); chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            const size_t count = chunk->count.load(std::memory_order_acquire);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const TraceEvent& event = chunk->events[i];
+
+                if (event.isAsync)
+                {
+                    asyncId++;
+
+                    out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"queue\",\"ph\":\"b\",\"id\":" << asyncId
+                        << ",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":";
+                    WriteMicroseconds(out, event.start);
+                    out << "},\n{\"name\":\"" << event.name << "\",\"cat\":\"queue\",\"ph\":\"e\",\"id\":" << asyncId
+                        << ",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":";
+                    WriteMicroseconds(out, event.end);
+                    out << "}";
+                }
+                else
+                {
+                    out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                        << buffer->threadId << ",\"ts\":";
+                    WriteMicroseconds(out, event.start);
+                    out << ",\"dur\":";
+                    WriteMicroseconds(out, event.end - event.start);
+                    out << "}";
+                }
+            }
+        }
+    }
+
+    out << "\n]}\n";
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("Failed to write the trace file: " + path.string());
+    }
+}
@@ -0,0 +1,68 @@
+/*
+* A utility that removes the name mangling from the debug symbol
+* function names in the SimCity 3000 Unlimited Linux release.
+*
+* Copyright (C) 2024 Nicholas Hayes
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+
+// Records the spans of the processing pipeline for the --trace option, the trace is written in the
+// Chrome trace event format that chrome://tracing and Perfetto can open.
+// Each thread records into its own buffer without locking, the buffers are combined when the trace is written.
+
+// Starts recording, this must be called before the worker threads start.
+void EnableTracing() noexcept;
+
+bool IsTracingEnabled() noexcept;
+
+// Returns the current time in nanoseconds since tracing was enabled.
+int64_t GetTraceTimestamp() noexcept;
+
+// Names the calling thread in the trace, the name must be a string literal.
+void SetTraceThreadName(const char* name) noexcept;
+
+// Adds a span to the calling thread, the name must be a string literal.
+void AddTraceSpan(const char* name, int64_t start, int64_t end) noexcept;
+
+// Adds a span that is shown on its own track, it may overlap the other spans of the thread.
+// This is used for the time that a task waits in the thread pool queue.
+void AddTraceAsyncSpan(const char* name, int64_t start, int64_t end) noexcept;
+
+// Records a span from construction to destruction when tracing is enabled.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) noexcept;
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    int64_t start;
+};
+
+#define TRACE_SPAN_CONCAT_INNER(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) const TraceSpan TRACE_SPAN_CONCAT(traceSpan, __LINE__)(name)
+
+// Writes the spans that all of the threads have recorded.
+void WriteTrace(const std::filesystem::path& path);
@@ -74,11 +74,45 @@ char* str;
 char* malloc();
 char* realloc();
 
+#ifdef DEMANGLE_ALLOC_STATS
+
+#if defined (_MSC_VER)
+#define DEMANGLE_THREAD_LOCAL __declspec(thread)
+#else
+#define DEMANGLE_THREAD_LOCAL __thread
+#endif
+
+static DEMANGLE_THREAD_LOCAL struct demangle_alloc_stats alloc_stats;
+
+#define ALLOC_STATS_ADD(field, n) (alloc_stats.field += (n))
+#define ALLOC_STATS_MAX(field, n) \
+  (alloc_stats.field = ((unsigned long) (n) > alloc_stats.field \
+                        ? (unsigned long) (n) : alloc_stats.field))
+
+void
+cplus_demangle_alloc_stats (stats, reset)
+     struct demangle_alloc_stats *stats;
+     int reset;
+{
+  *stats = alloc_stats;
+  if (reset)
+    memset (&alloc_stats, 0, sizeof (alloc_stats));
+}
+
+#else
+
+#define ALLOC_STATS_ADD(field, n)
+#define ALLOC_STATS_MAX(field, n)
+
+#endif /* DEMANGLE_ALLOC_STATS */
+
 char*
 xmalloc(size)
 unsigned size;
 {
     register char* value = (char*)malloc(size);
+    ALLOC_STATS_ADD(xmalloc_calls, 1);
+    ALLOC_STATS_ADD(allocated_bytes, size);
     if (value == 0)
         fatal("virtual memory exhausted");
     return value;
@@ -90,11 +124,29 @@ char* ptr;
 unsigned size;
 {
     register char* value = (char*)realloc(ptr, size);
+    ALLOC_STATS_ADD(xrealloc_calls, 1);
+    ALLOC_STATS_ADD(allocated_bytes, size);
     if (value == 0)
         fatal("virtual memory exhausted");
     return value;
 }
 
+#ifdef DEMANGLE_ALLOC_STATS
+
+/* Count the buffers that the demangler releases.  */
+
+static void
+counted_free (ptr)
+     void *ptr;
+{
+  ALLOC_STATS_ADD(free_calls, 1);
+  free (ptr);
+}
+
+#define free(ptr) counted_free (ptr)
+
+#endif /* DEMANGLE_ALLOC_STATS */
+
 /* In order to allow a single demangler executable to demangle strings
    using various common values of CPLUS_MARKER, as well as any specific
    one set at compile time, we maintain a string containing all the
@@ -160,8 +212,32 @@ struct work_stuff
   string* previous_argument; /* The last function argument demangled.  */
   int nrepeats;         /* The number of times to repeat the previous
                argument.  */
+  int type_depth;       /* The number of nested do_type calls.  */
+  int max_type_depth;   /* The length of the mangled name.  */
+  char *stack_base;     /* The address of a local variable of the function
+               that started the demangling.  */
+  int scope_length;     /* The length of the class or namespace scope at
+               the start of the declaration, -1 if there is none.  */
+  int last_scope_length; /* The scope_length of the declaration that
+               internal_cplus_demangle returned last.  */
 };
 
+/* Each qualifier or template argument of a type nests another do_type
+   call.  Every nesting level of a valid name has its own character in the
+   mangled name, a name that nests deeper than it is long is malformed,
+   e.g. it refers back to the type that contains it, and is rejected.  The
+   original egcs-1.1.2 code recurses until it overflows the stack.
+   A valid name is also rejected when the nested calls use more stack than
+   this, which leaves room on a 1 MB thread stack and allows several
+   hundred nesting levels.  */
+#define MAX_STACK_BYTES (256 * 1024)
+
+/* Far longer than the output of any real name, the N and n repeat counts
+   of a malformed name could otherwise make the output very large.  A name
+   is rejected when one of its argument lists grows longer than this, so the
+   work is bounded by the output size instead of the repeat count.  */
+#define MAX_DEMANGLED_LENGTH (1024 * 1024)
+
 #define PRINT_ANSI_QUALIFIERS (work -> options & DMGL_ANSI)
 #define PRINT_ARG_TYPES       (work -> options & DMGL_PARAMS)
 
@@ -282,6 +358,12 @@ demangle_method_args PARAMS ((struct work_stuff *, const char **, string *));
 static char *
 internal_cplus_demangle PARAMS ((struct work_stuff *, const char *));
 
+static void
+prepend_scope PARAMS ((struct work_stuff *, int));
+
+static int
+stack_budget_exceeded PARAMS ((struct work_stuff *));
+
 static int
 demangle_template_template_parm PARAMS ((struct work_stuff *work,
                      const char **, string *));
@@ -413,7 +495,9 @@ static int
 consume_count (type)
      const char **type;
 {
-  int count = 0;
+  /* Unsigned so that a count too large for an int wraps around instead
+     of overflowing, the callers check the count against the name.  */
+  unsigned int count = 0;
 
   while (isdigit (**type))
     {
@@ -421,7 +505,7 @@ consume_count (type)
       count += **type - '0';
       (*type)++;
     }
-  return (count);
+  return ((int) count);
 }
 
 
@@ -476,6 +560,8 @@ cplus_demangle_opname (opname, result, options)
   ret = 0;
   memset ((char *) work, 0, sizeof (work));
   work->options = options;
+  work->stack_base = (char *) &len;
+  work->max_type_depth = len;
 
   if (opname[0] == '_' && opname[1] == '_'
       && opname[2] == 'o' && opname[3] == 'p')
@@ -646,6 +732,27 @@ char *
 cplus_demangle (mangled, options)
      const char *mangled;
      int options;
+{
+  return cplus_demangle_with_scope (mangled, options, NULL);
+}
+
+/* Like cplus_demangle, and if SCOPE_LENGTH is not NULL, sets it to the
+   length of the class or namespace scope at the start of the result, or
+   to -1 if the result does not start with one.
+
+   cplus_demangle_with_scope ("foo__1Ai", DMGL_PARAMS, &n)	=> "A::foo(int)", n = 1
+   cplus_demangle_with_scope ("__Q23Foo3Bar", DMGL_PARAMS, &n)	=> "Foo::Bar::Bar(void)", n = 8
+   cplus_demangle_with_scope ("foo__Fi", DMGL_PARAMS, &n)	=> "foo(int)", n = -1
+
+   The scope is recorded where the demangler puts it in front of the name,
+   so a caller does not have to find the :: that ends it in the result,
+   e.g. in cArray<Foo::Bar>::Get(void).  */
+
+char *
+cplus_demangle_with_scope (mangled, options, scope_length)
+     const char *mangled;
+     int options;
+     int *scope_length;
 {
   char *ret;
   struct work_stuff work[1];
@@ -654,8 +761,13 @@ cplus_demangle (mangled, options)
   if ((work -> options & DMGL_STYLE_MASK) == 0)
     work -> options |= (int) current_demangling_style & DMGL_STYLE_MASK;
 
+  work -> stack_base = (char *) &ret;
+  work -> max_type_depth = mangled != NULL ? (int) strlen (mangled) : 0;
+
   ret = internal_cplus_demangle (work, mangled);
   squangle_mop_up (work);
+  if (scope_length != NULL)
+    *scope_length = ret != NULL ? work -> last_scope_length : -1;
   return (ret);
 }
 
@@ -677,14 +789,17 @@ internal_cplus_demangle (work, mangled)
   char *demangled = NULL;
   int s1,s2,s3,s4;
   int saved_volatile_type;
+  int saved_scope_length;
   s1 = work->constructor;
   s2 = work->destructor;
   s3 = work->static_type;
   s4 = work->const_type;
   saved_volatile_type = work->volatile_type;
+  saved_scope_length = work->scope_length;
   work->constructor = work->destructor = 0;
   work->static_type = work->const_type = 0;
   work->volatile_type = 0;
+  work->scope_length = -1;
 
   if ((mangled != NULL) && (*mangled != '\0'))
     {
@@ -713,22 +828,56 @@ internal_cplus_demangle (work, mangled)
         {
           string_prepend (&decl, "global constructors keyed to ");
           work->constructor = 0;
+          work->scope_length = -1;
         }
       else if (work->destructor == 2)
         {
           string_prepend (&decl, "global destructors keyed to ");
           work->destructor = 0;
+          work->scope_length = -1;
         }
       demangled = mop_up (work, &decl, success);
     }
+  /* A nested call, e.g. for the method of a thunk, does not change the
+     scope of the declaration that the caller is building.  */
+  work->last_scope_length = work->scope_length;
   work->constructor = s1;
   work->destructor = s2;
   work->static_type = s3;
   work->const_type = s4;
   work->volatile_type = saved_volatile_type;
+  work->scope_length = saved_scope_length;
   return (demangled);
 }
 
+/* Records that a scope of LENGTH characters and a :: separator were put in
+   front of the declaration, in front of its existing scope if it has one.  */
+
+static void
+prepend_scope (work, length)
+     struct work_stuff *work;
+     int length;
+{
+  if (work->scope_length < 0)
+    work->scope_length = length;
+  else
+    work->scope_length += length + 2;
+}
+
+/* Returns nonzero if the demangling call has used more than
+   MAX_STACK_BYTES of the stack, the stack can grow in either direction.  */
+
+static int
+stack_budget_exceeded (work)
+     struct work_stuff *work;
+{
+  char here;
+  size_t base = (size_t) work->stack_base;
+  size_t current = (size_t) &here;
+
+  return (base > current ? base - current : current - base) > MAX_STACK_BYTES;
+}
+
 
 /* Clear out and squangling related storage */
 static void
@@ -764,6 +913,7 @@ mop_up (work, declp, success)
     {
       free ((char *) work -> typevec);
       work -> typevec = NULL;
+      work -> typevec_size = 0;
     }
   if (work->tmpl_argvec)
     {
@@ -780,6 +930,7 @@ mop_up (work, declp, success)
     {
       string_delete (work->previous_argument);
       free ((char*) work->previous_argument);
+      work->previous_argument = NULL;
     }
 
   /* If demangling was successful, ensure that the demangled string is null
@@ -912,6 +1063,7 @@ demangle_signature (work, mangled, declp)
         success = do_type (work, mangled, &s);
         if (success)
           {
+        prepend_scope (work, LEN_STRING (&s));
         string_append (&s, SCOPE_STRING (work));
         string_prepends (declp, &s);
           }
@@ -957,6 +1109,7 @@ demangle_signature (work, mangled, declp)
         {
           remember_type (work, oldmangled, *mangled - oldmangled);
         }
+      prepend_scope (work, LEN_STRING (&tname));
       string_append(&tname, SCOPE_STRING (work));
       string_prepends(declp, &tname);
       if (work -> destructor & 1)
@@ -987,6 +1140,8 @@ demangle_signature (work, mangled, declp)
           success = do_type (work, mangled, &return_type);
           APPEND_BLANK (&return_type);
 
+          /* The declaration no longer starts with its scope.  */
+          work->scope_length = -1;
           string_prepends (declp, &return_type);
           string_delete (&return_type);
           break;
@@ -1284,11 +1439,10 @@ demangle_template_value_parm (work, mangled, s)
       break;
     case 'B':	/* remembered type */
     case 'T':	/* remembered type */
-      abort ();
-      break;
     case 'v':	/* void */
-      abort ();
-      break;
+      /* These cannot be the type of a value parameter, reject the name
+	 instead of aborting so that one bad name does not stop a batch.  */
+      return 0;
     case 'x':	/* long long */
     case 'l':	/* long */
     case 'i':	/* int */
@@ -1449,7 +1603,7 @@ demangle_template (work, mangled, tname, trawname, is_type, remember)
   int success = 0;
   const char *start;
   string temp;
-  int bindex;
+  int bindex = 0;
 
   (*mangled)++;
   if (is_type)
@@ -1498,8 +1652,9 @@ demangle_template (work, mangled, tname, trawname, is_type, remember)
     }
     }
   string_append (tname, "<");
-  /* get size of template parameter list */
-  if (!get_count (mangled, &r))
+  /* get size of template parameter list, each parameter takes at least
+     one character of the name.  */
+  if (!get_count (mangled, &r) || r < 0 || (size_t) r > strlen (*mangled))
     {
       return (0);
     }
@@ -1532,7 +1687,8 @@ demangle_template (work, mangled, tname, trawname, is_type, remember)
           /* Save the template argument. */
           int len = temp.p - temp.b;
           work->tmpl_argvec[i] = xmalloc (len + 1);
-          memcpy (work->tmpl_argvec[i], temp.b, len);
+          if (len > 0)
+            memcpy (work->tmpl_argvec[i], temp.b, len);
           work->tmpl_argvec[i][len] = '\0';
         }
         }
@@ -1615,7 +1771,8 @@ demangle_template (work, mangled, tname, trawname, is_type, remember)
         {
           int len = s->p - s->b;
           work->tmpl_argvec[i] = xmalloc (len + 1);
-          memcpy (work->tmpl_argvec[i], s->b, len);
+          if (len > 0)
+            memcpy (work->tmpl_argvec[i], s->b, len);
           work->tmpl_argvec[i][len] = '\0';
 
           string_appends (tname, s);
@@ -1788,6 +1945,7 @@ demangle_class (work, mangled, declp)
     }
       remember_Ktype (work, class_name.b, LEN_STRING(&class_name));
       remember_Btype (work, class_name.b, LEN_STRING(&class_name), btype);
+      prepend_scope (work, LEN_STRING (&class_name));
       string_prepend (declp, SCOPE_STRING (work));
       string_prepends (declp, &class_name);
       success = 1;
@@ -2081,7 +2239,7 @@ gnu_special (work, mangled, declp)
              ".<digits>" indicating a static local symbol.  In
              any case, declare victory and move on; *don't* try
              to use n to allocate.  */
-          if (n > strlen (*mangled))
+          if (n < 0 || (size_t) n > strlen (*mangled))
             {
               success = 1;
               break;
@@ -2129,6 +2287,13 @@ gnu_special (work, mangled, declp)
       break;
     default:
       n = consume_count (mangled);
+      /* A count longer than the rest of the name cannot be a
+         class name; reject it instead of reading past the end.  */
+      if (n < 0 || (size_t) n > strlen (*mangled))
+        {
+          success = 0;
+          break;
+        }
       string_appendn (declp, *mangled, n);
       (*mangled) += n;
     }
@@ -2137,6 +2302,7 @@ gnu_special (work, mangled, declp)
       /* Consumed everything up to the cplus_marker, append the
          variable name.  */
       (*mangled)++;
+      prepend_scope (work, LEN_STRING (declp));
       string_append (declp, SCOPE_STRING (work));
       n = strlen (*mangled);
       string_appendn (declp, *mangled, n);
@@ -2331,7 +2497,7 @@ demangle_qualified (work, mangled, result, isfuncname, append)
       int idx;
       (*mangled)++;
       idx = consume_count_with_underscores (mangled);
-      if (idx == -1 || idx > work -> numk)
+      if (idx == -1 || idx >= work -> numk)
         success = 0;
       else
         string_append (&temp, work -> ktypevec[idx]);
@@ -2419,7 +2585,7 @@ demangle_qualified (work, mangled, result, isfuncname, append)
           int idx;
           (*mangled)++;
           idx = consume_count_with_underscores (mangled);
-          if (idx == -1 || idx > work->numk)
+          if (idx == -1 || idx >= work->numk)
             success = 0;
           else
             string_append (&temp, work->ktypevec[idx]);
@@ -2449,6 +2615,10 @@ demangle_qualified (work, mangled, result, isfuncname, append)
      We do this here because this is the most convenient place, where
      we already have a pointer to the name and the length of the name.  */
 
+  /* The prepended names are the scope of the function name in RESULT.  */
+  if (!append && (isfuncname || !STRING_EMPTY (result)))
+    prepend_scope (work, LEN_STRING (&temp));
+
   if (isfuncname)
     {
       string_append (&temp, SCOPE_STRING (work));
@@ -2496,7 +2666,7 @@ get_count (type, count)
      int *count;
 {
   const char *p;
-  int n;
+  unsigned int n;
 
   if (!isdigit (**type))
     {
@@ -2520,7 +2690,7 @@ get_count (type, count)
       if (*p == '_')
         {
           *type = p + 1;
-          *count = n;
+          *count = (int) n;
         }
     }
     }
@@ -2542,14 +2712,21 @@ do_type (work, mangled, result)
   const char *remembered_type;
   int constp;
   int volatilep;
+  int followed_types;
   string btype;
 
   string_init (&btype);
   string_init (&decl);
   string_init (result);
 
+  if (work -> type_depth >= work -> max_type_depth
+      || stack_budget_exceeded (work))
+    return (0);
+  work -> type_depth++;
+
   done = 0;
   success = 1;
+  followed_types = 0;
   while (success && !done)
     {
       int member;
@@ -2594,7 +2771,10 @@ do_type (work, mangled, result)
     /* A back reference to a previously seen type */
     case 'T':
       (*mangled)++;
-      if (!get_count (mangled, &n) || n >= work -> ntypes)
+      /* A chain of back references longer than the number of remembered
+         types has a cycle, e.g. a remembered type that refers to itself.  */
+      if (!get_count (mangled, &n) || n >= work -> ntypes
+          || ++followed_types > work -> ntypes)
         {
           success = 0;
         }
@@ -2680,11 +2860,13 @@ do_type (work, mangled, result)
             (*mangled)++;
             volatilep = 1;
           }
-        if (*(*mangled)++ != 'F')
+        /* Do not step past the end of the name if it is missing.  */
+        if (**mangled != 'F')
           {
             success = 0;
             break;
           }
+        (*mangled)++;
           }
         if ((member && !demangle_nested_args (work, mangled, &decl))
         || **mangled != '_')
@@ -2810,6 +2992,7 @@ do_type (work, mangled, result)
       string_delete (result);
     }
   string_delete (&decl);
+  work -> type_depth--;
   return (success);
 }
 
@@ -3075,6 +3258,7 @@ remember_type (work, start, len)
 
   if (work -> ntypes >= work -> typevec_size)
     {
+      ALLOC_STATS_ADD(typevec_grows, 1);
       if (work -> typevec_size == 0)
     {
       work -> typevec_size = 3;
@@ -3090,9 +3274,11 @@ remember_type (work, start, len)
     }
     }
   tem = xmalloc (len + 1);
-  memcpy (tem, start, len);
+  if (len > 0)
+    memcpy (tem, start, len);
   tem[len] = '\0';
   work -> typevec[work -> ntypes++] = tem;
+  ALLOC_STATS_MAX(typevec_max, work -> ntypes);
 }
 
 
@@ -3107,6 +3293,7 @@ remember_Ktype (work, start, len)
 
   if (work -> numk >= work -> ksize)
     {
+      ALLOC_STATS_ADD(ktypevec_grows, 1);
       if (work -> ksize == 0)
     {
       work -> ksize = 5;
@@ -3122,9 +3309,11 @@ remember_Ktype (work, start, len)
     }
     }
   tem = xmalloc (len + 1);
-  memcpy (tem, start, len);
+  if (len > 0)
+    memcpy (tem, start, len);
   tem[len] = '\0';
   work -> ktypevec[work -> numk++] = tem;
+  ALLOC_STATS_MAX(ktypevec_max, work -> numk);
 }
 
 /* Register a B code, and get an index for it. B codes are registered
@@ -3139,6 +3328,7 @@ register_Btype (work)
 
   if (work -> numb >= work -> bsize)
     {
+      ALLOC_STATS_ADD(btypevec_grows, 1);
       if (work -> bsize == 0)
     {
       work -> bsize = 5;
@@ -3154,6 +3344,7 @@ register_Btype (work)
     }
     }
   ret = work -> numb++;
+  ALLOC_STATS_MAX(btypevec_max, work -> numb);
   work -> btypevec[ret] = NULL;
   return(ret);
 }
@@ -3169,7 +3360,8 @@ remember_Btype (work, start, len, index)
   char *tem;
 
   tem = xmalloc (len + 1);
-  memcpy (tem, start, len);
+  if (len > 0)
+    memcpy (tem, start, len);
   tem[len] = '\0';
   work -> btypevec[index] = tem;
 }
@@ -3274,6 +3466,8 @@ demangle_args (work, mangled, declp)
   int t;
   const char *tem;
   char temptype;
+  /* The length of the argument list, counted even if it is not printed.  */
+  long args_length = 0;
 
   if (PRINT_ARG_TYPES)
     {
@@ -3287,6 +3481,10 @@ demangle_args (work, mangled, declp)
   while ((**mangled != '_' && **mangled != '\0' && **mangled != 'e')
      || work->nrepeats > 0)
     {
+      if (args_length > MAX_DEMANGLED_LENGTH)
+    {
+      return (0);
+    }
       if ((**mangled == 'N') || (**mangled == 'T'))
     {
       temptype = *(*mangled)++;
@@ -3334,6 +3532,10 @@ demangle_args (work, mangled, declp)
         }
       while (work->nrepeats > 0 || --r >= 0)
         {
+          if (args_length > MAX_DEMANGLED_LENGTH)
+        {
+          return (0);
+        }
           tem = work -> typevec[t];
           if (need_comma && PRINT_ARG_TYPES)
         {
@@ -3347,6 +3549,7 @@ demangle_args (work, mangled, declp)
         {
           string_appends (declp, &arg);
         }
+          args_length += LEN_STRING (&arg) + 2;
           string_delete (&arg);
           need_comma = 1;
         }
@@ -3359,6 +3562,7 @@ demangle_args (work, mangled, declp)
         return (0);
       if (PRINT_ARG_TYPES)
         string_appends (declp, &arg);
+      args_length += LEN_STRING (&arg) + 2;
       string_delete (&arg);
       need_comma = 1;
     }
@@ -3591,6 +3795,7 @@ string_need (s, n)
     }
   else if (s->e - s->p < n)
     {
+      ALLOC_STATS_ADD(string_need_reallocs, 1);
       tem = s->p - s->b;
       n += tem;
       n *= 2;
@@ -3711,6 +3916,7 @@ string_prependn (p, s, n)
   if (n != 0)
     {
       string_need (p, n);
+      ALLOC_STATS_ADD(prepend_bytes_moved, p->p - p->b);
       for (q = p->p - 1; q >= p->b; q--)
     {
       q[n] = q[0];
@@ -3720,6 +3926,72 @@ string_prependn (p, s, n)
     }
 }
 
+/* Run a single parsing stage on MANGLED, which must start at the construct
+   that the stage parses, e.g. "Q23Foo3Bar" for demangle_stage_qualified or
+   "t6vector1Zi" for demangle_stage_template.  The demangle_stage_strings
+   stage runs the string helpers on the characters of MANGLED.  The result
+   is discarded, the return value is nonzero if the stage succeeded.  */
+
+int
+cplus_demangle_stage (stage, mangled, options)
+     int stage;
+     const char *mangled;
+     int options;
+{
+  struct work_stuff work[1];
+  string result;
+  string temp;
+  int success = 0;
+  int n;
+
+  memset ((char *) work, 0, sizeof (work));
+  work -> options = options;
+  work -> stack_base = (char *) &n;
+  work -> max_type_depth = (int) strlen (mangled);
+  if ((work -> options & DMGL_STYLE_MASK) == 0)
+    work -> options |= (int) current_demangling_style & DMGL_STYLE_MASK;
+
+  string_init (&result);
+  string_init (&temp);
+
+  switch (stage)
+    {
+    case demangle_stage_prefix:
+      success = demangle_prefix (work, &mangled, &result);
+      break;
+    case demangle_stage_gnu_special:
+      success = gnu_special (work, &mangled, &result);
+      break;
+    case demangle_stage_qualified:
+      success = demangle_qualified (work, &mangled, &result, 0, 1);
+      break;
+    case demangle_stage_type:
+      success = do_type (work, &mangled, &result);
+      break;
+    case demangle_stage_template:
+      success = demangle_template (work, &mangled, &result, &temp, 1, 1);
+      break;
+    case demangle_stage_args:
+      success = demangle_args (work, &mangled, &result);
+      break;
+    case demangle_stage_strings:
+      n = strlen (mangled);
+      string_appendn (&temp, mangled, n);
+      string_append (&result, mangled);
+      string_prependn (&result, mangled, n);
+      string_appends (&result, &temp);
+      string_prepends (&result, &temp);
+      string_prepend (&result, "::");
+      success = result.p > result.b;
+      break;
+    }
+
+  string_delete (&temp);
+  mop_up (work, &result, 0);
+  squangle_mop_up (work);
+  return success;
+}
+
 /* To generate a standalone demangler program for testing purposes,
    just compile and link this file with -DMAIN and libiberty.a.  When
    run, it demangles each command line arg, or each stdin string, and
@@ -76,12 +76,71 @@ extern enum demangling_styles
 extern char *
 cplus_demangle PARAMS ((const char *mangled, int options));
 
+/* Like cplus_demangle, also returns the length of the class or namespace
+   scope at the start of the result in *SCOPE_LENGTH, or -1 if there is no
+   scope, e.g. 9 for cRZSample::Foo(int).  */
+
+extern char *
+cplus_demangle_with_scope PARAMS ((const char *mangled, int options, int *scope_length));
+
 extern int
 cplus_demangle_opname PARAMS ((const char *opname, char *result, int options));
 
 extern const char *
 cplus_mangle_opname PARAMS ((const char *opname, int options));
 
+/* The parsing stages that cplus_demangle_stage can run on their own, this
+   is used to measure the cost of each stage.  */
+
+enum cplus_demangle_stages
+{
+  demangle_stage_prefix,
+  demangle_stage_gnu_special,
+  demangle_stage_qualified,
+  demangle_stage_type,
+  demangle_stage_template,
+  demangle_stage_args,
+  demangle_stage_strings
+};
+
+extern int
+cplus_demangle_stage PARAMS ((int stage, const char *mangled, int options));
+
+#ifdef DEMANGLE_ALLOC_STATS
+
+/* Allocation and buffer growth counters, collected when cplus-dem.c is
+   compiled with DEMANGLE_ALLOC_STATS defined.  The counters are kept per
+   thread and cover the demangling calls made by the calling thread.  */
+
+struct demangle_alloc_stats
+{
+  unsigned long xmalloc_calls;
+  unsigned long xrealloc_calls;
+  unsigned long free_calls;
+  /* The bytes requested from xmalloc and xrealloc.  */
+  unsigned long allocated_bytes;
+  /* The string_need calls that had to grow an existing buffer.  */
+  unsigned long string_need_reallocs;
+  /* The bytes that string_prependn moved to make room at the start.  */
+  unsigned long prepend_bytes_moved;
+  /* The number of times the vectors were allocated or grown, and the most
+     entries that they held.  */
+  unsigned long typevec_grows;
+  unsigned long ktypevec_grows;
+  unsigned long btypevec_grows;
+  unsigned long typevec_max;
+  unsigned long ktypevec_max;
+  unsigned long btypevec_max;
+};
+
+/* Copy the counters of the calling thread to STATS, then clear them if
+   RESET is nonzero.  */
+
+extern void
+cplus_demangle_alloc_stats PARAMS ((struct demangle_alloc_stats *stats, int reset));
+
+#endif /* DEMANGLE_ALLOC_STATS */
+
 /* Note: This sets global state.  FIXME if you care about multi-threading. */
 
 extern void
@@ -19,309 +19,678 @@
 *
 */
 
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <random>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
-
-extern "C"
+#include "AddressIndex.h"
+#include "Benchmark.h"
+#include "ClassDump.h"
+#include "ClassDumpDirectory.h"
+#include "CorpusGenerator.h"
+#include "CorpusVerifier.h"
+#include "CrashLogSymbolizer.h"
+#include "DemangleCache.h"
+#include "DemangleClient.h"
+#include "DemangleFuzzer.h"
+#include "DemangleServer.h"
+#include "DemangleStats.h"
+#include "DemangleTree.h"
+#include "DemangleUtil.h"
+#include "Demangler.h"
+#include "ElfSymbolReader.h"
+#include "HeaderGenerator.h"
+#include "PerfIntegration.h"
+#include "PersistentDemangleCache.h"
+#include "ScalingBenchmark.h"
+#include "StreamFilter.h"
+#include "SymbolList.h"
+#include "TextFilter.h"
+#include "ThreadPool.h"
+#include "Tracing.h"
+
+static void PrintUsage()
 {
-#include "demangle.h"
+    std::cout << "Usage SC3KLinuxDemangle input.txt [output.txt]\nThe output file is optional, when it is omitted the input file will be overwritten." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --stdin\nDemangles the function names read from stdin and writes them to stdout, '-' can be used instead of --stdin." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --filter\nCopies the text from stdin to stdout, replacing any mangled names in the text with their demangled form." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --elf binary [output.txt]\nDemangles the symbol table of a 32-bit ELF file, the symbols are written to stdout when the output file is omitted." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --headers symbols output_directory\nWrites one header per class, the symbols can be an ELF file or a text file with one mangled name per line." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --symbolize binary [crash_log | directory]\nResolves the addresses and demangles the names in crash logs, stdin is used when the log is omitted." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --perf-script\nDemangles the symbol names in perf script output read from stdin, the result is written to stdout." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --perf-map binary (pid | output.map)\nWrites a perf map file with the demangled symbol names, a process id writes /tmp/perf-<pid>.map." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --benchmark-lookup binary [count]\nMeasures the address to symbol lookup rate for the ELF file." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --update input_directory output_directory\nDemangles the class dumps that changed since the previous run, unchanged headers are not rewritten." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --watch input_directory [output_directory]\nRegenerates the headers when class dumps in the directory change, the headers are written to the input directory when the output directory is omitted." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --server socket_path\nRuns a demangle server on a Unix domain socket." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --client socket_path\nDemangles the names read from stdin using a demangle server, the result is written to stdout." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --benchmark-demangle [iterations]\nMeasures the time per symbol of each demangler stage and of the complete demangler." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --benchmark-scaling input_file results_json [max_lines [baseline_json [tolerance]]]\nMeasures the class dump conversion throughput for each input size and thread count, exits with code 2 when a result regressed compared to the baseline." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --fuzz-demangle corpus_directory [iterations [seed]]\nRuns mutated mangled names through the demangling paths, reports mismatches between them and saves the inputs whose cost grows faster than their length." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --check-complexity corpus_directory [tolerance]\nMeasures the inputs saved by --fuzz-demangle again, exits with code 2 when the cost of an input regressed." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --verify-corpus input_file [expected_file]\nCompares the output of each demangling path to the reference demangler for the names of the input file, exits with code 2 when a path differs." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --demangle-tree symbols [output.jsonl]\nWrites the parse tree of each demangled name as one JSON object per line, the trees are written to stdout when the output file is omitted." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --generate-corpus output_prefix count [seed] [name=value ...]\nWrites random mangled names to <output_prefix>.txt and the reference demangler output to <output_prefix>.expected.txt." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle [--stats] [--stats-json file] [--stats-slowest count] <mode> [arguments]\nWrites the time spent in each processing phase, the line counters, the symbol latency percentiles and the slowest symbols to stderr, or as JSON to the file, when the mode finishes." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --trace trace.json <mode> [arguments]\nRecords the read, demangle, write and queue wait spans of each thread and writes them in the Chrome trace event format when the mode finishes." << std::endl;
+    std::cout << "Usage SC3KLinuxDemangle --cache cache_file <mode> [arguments]\nStores the demangled names in a cache file that is reused by later runs, the option can be used with every mode." << std::endl;
 }
 
-static const std::vector<std::pair<std::string, std::string>> ParameterSubstitutions
+static void WriteElfSymbols(const ElfSymbolReader& reader, std::ostream& out)
 {
-    // The demangler puts a space in front of a pointer or reference modifier.
-    std::pair<std::string, std::string>(" &", "&"),
-    std::pair<std::string, std::string>(" *", "*"),
-    std::pair<std::string, std::string>(" **", "**"),
-    // All unsigned values come first so that they are correctly handled.
-    std::pair<std::string, std::string>("unsigned char", "uint8_t"),
-    std::pair<std::string, std::string>("unsigned short", "uint16_t"),
-    std::pair<std::string, std::string>("unsigned int", "uint32_t"),
-    std::pair<std::string, std::string>("unsigned long", "uint32_t"),
-    std::pair<std::string, std::string>("unsigned long long", "uint64_t"),
-    std::pair<std::string, std::string>("char", "int8_t"),
-    std::pair<std::string, std::string>("short", "int16_t"),
-    std::pair<std::string, std::string>("int", "int32_t"),
-    std::pair<std::string, std::string>("long", "int32_t"),
-    std::pair<std::string, std::string>("long long", "int64_t"),
-};
-
-class DemanglerString
+    std::string demangled;
+    char prefix[64]{};
+
+    for (const ElfSymbol& symbol : reader.GetSymbols())
+    {
+        if (symbol.type != ElfSymbolType::Function && symbol.type != ElfSymbolType::Object && symbol.type != ElfSymbolType::NoType)
+        {
+            continue;
+        }
+
+        std::snprintf(prefix, sizeof(prefix), "%08x %08x ", symbol.value, symbol.size);
+
+        out << prefix << (symbol.sectionName.empty() ? "*UND*" : symbol.sectionName) << ' ';
+
+        // The symbol names are null-terminated in the string table, so they are passed directly to the demangler.
+        if (TryDemangle(symbol.name.data(), DemangleFormat::FixedWidthTypes, demangled))
+        {
+            out << demangled << '\n';
+        }
+        else
+        {
+            out << symbol.name << '\n';
+        }
+    }
+}
+
+static void DemangleElfSymbols(const std::filesystem::path& binary, const std::filesystem::path& output)
 {
-public:
-    DemanglerString(char* ptr) : ptr(ptr)
+    const ElfSymbolReader reader(binary);
+
+    if (output.empty())
     {
+        std::ios::sync_with_stdio(false);
+
+        WriteElfSymbols(reader, std::cout);
+        std::cout.flush();
     }
+    else
+    {
+        std::ofstream out(output, std::ofstream::out);
+
+        WriteElfSymbols(reader, out);
+        out.close();
 
-    ~DemanglerString()
+        if (out.fail())
+        {
+            throw std::runtime_error("Failed to write the output file.");
+        }
+    }
+}
+
+// Returns the number of names that the demangler rejected, these names are not written.
+static size_t WriteDemangleTrees(const SymbolList& symbols, std::ostream& out)
+{
+    Demangler demangler;
+    size_t rejectedCount = 0;
+
+    for (const std::string_view name : symbols.GetNames())
     {
-        char* localPtr = ptr;
-        ptr = nullptr;
+        const DemangleTree* const tree = demangler.DemangleToTree(name);
 
-        if (localPtr)
+        if (tree)
         {
-            free(localPtr);
+            WriteDemangleTreeJson(out, name, *tree);
         }
+        else
+        {
+            rejectedCount++;
+        }
+
+        // The trees are written immediately, so the arena only has to hold one of them.
+        demangler.ClearResults();
     }
 
-    const char* const Get() const noexcept
+    return rejectedCount;
+}
+
+static void DemangleSymbolTrees(const std::filesystem::path& input, const std::filesystem::path& output)
+{
+    const SymbolList symbols(input);
+
+    if (output.empty())
     {
-        return ptr;
+        std::ios::sync_with_stdio(false);
+
+        WriteDemangleTrees(symbols, std::cout);
+        std::cout.flush();
     }
+    else
+    {
+        std::ofstream out(output, std::ofstream::out);
 
-private:
-    char* ptr;
-};
+        const size_t rejectedCount = WriteDemangleTrees(symbols, out);
+        out.close();
 
-// Adapted from https://stackoverflow.com/a/24315631
-static inline void DoFunctionParameterSubstitution(std::string& str, const std::string& from, const std::string& to)
+        if (out.fail())
+        {
+            throw std::runtime_error("Failed to write the output file.");
+        }
+
+        std::cout << "Wrote " << (symbols.GetNames().size() - rejectedCount) << " tree(s), " << rejectedCount << " name(s) were rejected by the demangler." << std::endl;
+    }
+}
+
+namespace
 {
-    size_t start_pos = 0;
-    while ((start_pos = str.find(from, start_pos)) != std::string::npos) {
+    // Writes the statistics when main returns, the summary goes to stderr because stdout can be the mode output.
+    class StatsReport
+    {
+    public:
+        StatsReport() = default;
+
+        ~StatsReport()
+        {
+            try
+            {
+                if (writeSummary)
+                {
+                    WriteDemangleStatsSummary(std::cerr);
+                }
+
+                if (!jsonPath.empty())
+                {
+                    std::ofstream out(jsonPath, std::ofstream::out | std::ofstream::trunc);
+                    WriteDemangleStatsJson(out);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+
+        StatsReport(const StatsReport&) = delete;
+        StatsReport& operator=(const StatsReport&) = delete;
+
+        void EnableSummary() noexcept
+        {
+            writeSummary = true;
+        }
 
-        if (start_pos > 0)
+        void EnableJson(const std::filesystem::path& path)
         {
-            // Check that the term we are replacing is a whole word, this prevents a double replacement.
-            // For example, uint32_t being converted to uint32_t32_t
+            jsonPath = path;
+        }
 
-            char previous = str[start_pos - 1];
-            char next = str[start_pos + from.length() + 1];
+        void SetSlowestSymbolCount(size_t count) noexcept
+        {
+            slowestSymbolCount = count;
+        }
 
-            // The first character in 'from' is checked for the replacement strings that
-            // strip a leading space from the &, * and ** operators.
-            if ((previous == ' ' || previous == '(' || from[0] == ' ')
-                && (next == ',' || next == ')' || next == ' ' || next == '\0'))
+        // Starts collecting the statistics if a report was requested.
+        void Start() const
+        {
+            if (!writeSummary && jsonPath.empty())
             {
-                str.replace(start_pos, from.length(), to);
+                return;
             }
+
+#if SC3K_DEMANGLE_STATS
+            EnableDemangleStats(slowestSymbolCount);
+#else
+            throw std::runtime_error("This build does not collect statistics, it was compiled with SC3K_DEMANGLE_STATS set to 0.");
+#endif
         }
 
-        start_pos += to.length(); // Handles case where 'to' is a substring of 'from'
-    }
+    private:
+        std::filesystem::path jsonPath;
+        size_t slowestSymbolCount = 10;
+        bool writeSummary = false;
+    };
+
+    // Writes the trace when main returns, after the thread pools of the mode have exited.
+    class TraceReport
+    {
+    public:
+        TraceReport() = default;
+
+        ~TraceReport()
+        {
+            if (path.empty())
+            {
+                return;
+            }
+
+            try
+            {
+                WriteTrace(path);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+
+        TraceReport(const TraceReport&) = delete;
+        TraceReport& operator=(const TraceReport&) = delete;
+
+        void Start(const std::filesystem::path& tracePath) noexcept
+        {
+            path = tracePath;
+            EnableTracing();
+            SetTraceThreadName("main");
+        }
+
+    private:
+        std::filesystem::path path;
+    };
 }
 
-static std::string GetDemangledLine(const char* const mangledLine)
+int main(int nargs, char* argv[])
 {
-    DemanglerString demangled(cplus_demangle(mangledLine, DMGL_PARAMS | DMGL_ANSI));
+    if (nargs < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
 
-    std::string result(demangled.Get());
+    std::unique_ptr<PersistentDemangleCache> persistentCache;
+    // Declared before the mode runs so that the statistics are written after its thread pools have exited.
+    StatsReport statsReport;
+    TraceReport traceReport;
 
-    for (const auto& item : ParameterSubstitutions)
+    try
     {
-        DoFunctionParameterSubstitution(result, item.first, item.second);
-    }
+        // The global options are removed so that the mode arguments are parsed as usual.
+        while (nargs > 1)
+        {
+            const std::string_view option = argv[1];
+            int optionArgs;
 
-    return result;
-}
+            if (option == "--cache" && nargs >= 4)
+            {
+                persistentCache = std::make_unique<PersistentDemangleCache>(argv[2]);
+                SetPersistentDemangleCache(persistentCache.get());
+                optionArgs = 2;
+            }
+            else if (option == "--stats" && nargs >= 3)
+            {
+                statsReport.EnableSummary();
+                optionArgs = 1;
+            }
+            else if (option == "--stats-json" && nargs >= 4)
+            {
+                statsReport.EnableJson(argv[2]);
+                optionArgs = 2;
+            }
+            else if (option == "--trace" && nargs >= 4)
+            {
+                traceReport.Start(argv[2]);
+                optionArgs = 2;
+            }
+            else if (option == "--stats-slowest" && nargs >= 4)
+            {
+                statsReport.SetSlowestSymbolCount(std::stoull(argv[2]));
+                optionArgs = 2;
+            }
+            else
+            {
+                break;
+            }
 
-static void DemangleInputFile(const std::filesystem::path& input, const std::filesystem::path& output)
-{
-    constexpr std::string_view VirtualFunctionPrototypePrefix = "virtual ";
-    constexpr std::string_view ThunkPrefix = "__thunk_";
+            argv[optionArgs] = argv[0];
+            argv += optionArgs;
+            nargs -= optionArgs;
+        }
 
-    std::ifstream in(input, std::ifstream::in);
-    std::ofstream out(output, std::ofstream::out);
+        if (nargs < 2)
+        {
+            PrintUsage();
+            return 1;
+        }
 
-    size_t functionNameStart = 0;
-    bool isGZUnknownClass = false;
+        statsReport.Start();
 
-    for (size_t lineIndex = 0; in.good(); lineIndex++)
-    {
-        std::string line;
-        std::getline(in, line);
+        const std::string_view firstArg = argv[1];
 
-        if (line.length() == 0)
+        if (firstArg == "-" || firstArg == "--stdin")
         {
-            // Skip any blank lines.
-            continue;
+            // Allow the stream to buffer the input so that it can report when no more data is available.
+            std::ios::sync_with_stdio(false);
+
+            DemangleStream(std::cin, stdout);
+            return 0;
+        }
+        else if (firstArg == "--filter")
+        {
+            DemangleCache cache(DemangleFormat::Classic);
+
+            DemangleText(stdin, stdout, cache);
+            return 0;
+        }
+        else if (firstArg == "--elf")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            DemangleElfSymbols(argv[2], nargs == 4 ? std::filesystem::path(argv[3]) : std::filesystem::path());
+            return 0;
         }
+        else if (firstArg == "--headers")
+        {
+            if (nargs != 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-        // Strip the virtual function prefix and suffix (if any), then strip the thunk prefix from
-        // the start of the mangled function name (if any).
-        // Both have to be removed for the GCC demangler to be able to process the function name.
+            const SymbolList symbols(argv[2]);
+            ThreadPool threadPool;
 
-        if (line.starts_with(VirtualFunctionPrototypePrefix))
+            const size_t headerCount = GenerateClassHeaders(symbols.GetNames(), argv[3], threadPool);
+
+            std::cout << "Wrote " << headerCount << " header(s) for " << symbols.GetNames().size() << " symbol(s)." << std::endl;
+            return 0;
+        }
+        else if (firstArg == "--update")
         {
-            // The virtual function prototype uses the following format: virtual <return type> <mangled name>(<parameters>).
-            // Trim the string to keep only <mangled name>.
+            if (nargs != 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-            size_t functionReturnTypeEnd = line.find(' ', VirtualFunctionPrototypePrefix.size() + 1);
+            DemangleInputDirectory(argv[2], argv[3]);
+            return 0;
+        }
+        else if (firstArg == "--watch")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-            if (functionReturnTypeEnd == std::string::npos)
+            WatchInputDirectory(argv[2], nargs == 4 ? argv[3] : argv[2]);
+            return 0;
+        }
+        else if (firstArg == "--server")
+        {
+            if (nargs != 3)
             {
-                throw std::runtime_error("Failed to find the end of the virtual function return type.");
+                PrintUsage();
+                return 1;
             }
 
-            size_t mangledNameStart = functionReturnTypeEnd + 1;
-            size_t mangledNameEnd = line.find('(', mangledNameStart);
+            ThreadPool threadPool;
 
-            if (mangledNameEnd == std::string::npos)
+            RunDemangleServer(argv[2], threadPool);
+            return 0;
+        }
+        else if (firstArg == "--client")
+        {
+            if (nargs != 3)
             {
-                throw std::runtime_error("Failed to find the end of the virtual function prototype prefix.");
+                PrintUsage();
+                return 1;
             }
 
-            line = line.substr(mangledNameStart, mangledNameEnd - mangledNameStart);
+            std::ios::sync_with_stdio(false);
+
+            DemangleClient client(argv[2]);
+            DemangleStreamWithServer(std::cin, std::cout, client);
+            return 0;
         }
+        else if (firstArg == "--symbolize")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            const ElfSymbolReader reader(argv[2]);
+            const AddressIndex addressIndex(reader);
+            DemangleCache cache(DemangleFormat::Classic);
 
-        if (line.starts_with(ThunkPrefix))
+            if (nargs == 3)
+            {
+                DemangleText(stdin, stdout, cache, &addressIndex);
+            }
+            else if (std::filesystem::is_directory(argv[3]))
+            {
+                ThreadPool threadPool;
+
+                const size_t logCount = SymbolizeCrashLogDirectory(argv[3], addressIndex, cache, threadPool);
+
+                std::cout << "Symbolized " << logCount << " crash log(s)." << std::endl;
+            }
+            else
+            {
+                SymbolizeCrashLog(argv[3], std::filesystem::path(), addressIndex, cache);
+            }
+            return 0;
+        }
+        else if (firstArg == "--perf-script")
         {
-            // The thunk prefix uses the format: __thunk_<unique number>_
-            // The function name follows this prefix.
+            DemangleCache cache(DemangleFormat::Classic);
+            ThreadPool threadPool;
 
-            size_t thunkPrefixEnd = line.find('_', ThunkPrefix.size() + 1);
+            FilterPerfScript(stdin, stdout, cache, threadPool);
+            return 0;
+        }
+        else if (firstArg == "--perf-map")
+        {
+            if (nargs != 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-            if (thunkPrefixEnd == std::string::npos)
+            const std::string_view target = argv[3];
+            std::filesystem::path output = argv[3];
+
+            if (target.find_first_not_of("0123456789") == std::string_view::npos)
             {
-                throw std::runtime_error("Failed to find the end of the thunk prefix.");
+                // perf looks for the map file of a process in /tmp.
+                output = "/tmp/perf-" + std::string(target) + ".map";
             }
 
-            line.erase(0, thunkPrefixEnd + 1);
+            const ElfSymbolReader reader(argv[2]);
+            const AddressIndex addressIndex(reader);
+            ThreadPool threadPool;
+
+            WritePerfMap(addressIndex, output, threadPool);
+            return 0;
         }
+        else if (firstArg == "--benchmark-lookup")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-        const std::string result = GetDemangledLine(line.c_str());
-        std::string_view resultAsStringView(result);
+            const size_t lookupCount = nargs == 4 ? std::stoull(argv[3]) : 10000000;
 
-        if (lineIndex == 0)
+            RunAddressLookupBenchmark(argv[2], lookupCount);
+            return 0;
+        }
+        else if (firstArg == "--benchmark-demangle")
         {
-            // We strip the class name from the start of the function string
-            // when writing it to the output.
-            size_t index = result.find_first_of("::");
+            if (nargs > 3)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-            if (index != std::string::npos)
+            RunDemangleBenchmark(nargs == 3 ? std::stoull(argv[2]) : 20000);
+            return 0;
+        }
+        else if (firstArg == "--benchmark-scaling")
+        {
+            if (nargs < 4 || nargs > 7)
             {
-                functionNameStart = index + 2;
-                isGZUnknownClass = resultAsStringView.substr(functionNameStart).compare("QueryInterface(uint32_t, void**)") == 0;
+                PrintUsage();
+                return 1;
+            }
 
-                // Write the class name at the top of the file.
+            ScalingBenchmarkOptions options;
+            std::filesystem::path baseline;
 
-                if (isGZUnknownClass)
-                {
-                    std::string className = result.substr(0, index);
-
-                    if (className[0] == 'c')
-                    {
-                        if (className.starts_with("cRZ"))
-                        {
-                            // The cRZ class prefixes are changed to cIGZ.
-                            // For example, cRZLanguageManager will be converted to cIGZLanguageManager.
-                            className.replace(0, 3, "cIGZ");
-                        }
-                        else
-                        {
-                            // Change the class name to its interface form, the 'c' at the start of the name
-                            // will be replaced with 'cI'.
-                            // For example, cSC3App will be converted to cISC3App.
-                            className.replace(0, 1, "cI");
-                        }
-                    }
-
-                    out << "#pragma once" << std::endl;
-                    out << "#include \"cIGZUnknown.h\"" << std::endl << std::endl;
-                    out << "class " << className << " : public cIGZUnknown" << std::endl;
-                    out << '{' << std::endl;
-                    out << "public:" << std::endl;
-
-                    // We don't write the QueryInterface method to the file.
-                    continue;
-                }
-                else
-                {
-                    out << "#pragma once" << std::endl << std::endl;
-                    out << "class " << resultAsStringView.substr(0, index) << std::endl;
-                    out << '{' << std::endl;
-                    out << "public:" << std::endl;
-                }
+            if (nargs > 4)
+            {
+                options.maxLineCount = std::stoull(argv[4]);
+            }
+
+            if (nargs > 5)
+            {
+                baseline = argv[5];
             }
+
+            if (nargs > 6)
+            {
+                options.regressionTolerance = std::stod(argv[6]);
+            }
+
+            // A regression uses a different exit code than the errors.
+            return RunScalingBenchmark(argv[2], argv[3], baseline, options) ? 0 : 2;
         }
-        else if (lineIndex < 3 && isGZUnknownClass)
+        else if (firstArg == "--fuzz-demangle")
         {
-            // We don't write the AddRef or Release methods to the file.
-            continue;
+            if (nargs < 3 || nargs > 5)
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            FuzzOptions options;
+
+            if (nargs > 3)
+            {
+                options.iterations = std::stoull(argv[3]);
+            }
+
+            if (nargs > 4)
+            {
+                options.seed = std::stoull(argv[4]);
+            }
+
+            const FuzzResult result = RunDemangleFuzzer(argv[2], options);
+
+            std::cout << "Ran " << result.inputCount << " input(s), " << result.rejectedCount << " rejected by the demangler, "
+                      << result.savedCount << " new slow input(s), " << result.mismatchCount << " mismatch(es)." << std::endl;
+            return result.mismatchCount == 0 ? 0 : 2;
         }
+        else if (firstArg == "--check-complexity")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-        out << "    virtual void* " << resultAsStringView.substr(functionNameStart) << " = 0;" << std::endl;
-    }
+            const double tolerance = nargs > 3 ? std::stod(argv[3]) : 1.0;
 
-    out << "};" << std::endl;
-}
+            return CheckDemangleComplexity(argv[2], tolerance) ? 0 : 2;
+        }
+        else if (firstArg == "--verify-corpus")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-// https://stackoverflow.com/a/24586587
-static std::string GetRandomFileName(std::string::size_type length)
-{
-    static auto& chrs = "0123456789"
-        "abcdefghijklmnopqrstuvwxyz"
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+            ThreadPool threadPool;
 
-    thread_local static std::mt19937 rg{ std::random_device{}() };
-    thread_local static std::uniform_int_distribution<std::string::size_type> pick(0, sizeof(chrs) - 2);
+            return VerifyCorpus(argv[2], nargs > 3 ? argv[3] : std::filesystem::path(), threadPool) ? 0 : 2;
+        }
+        else if (firstArg == "--demangle-tree")
+        {
+            if (nargs < 3 || nargs > 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-    std::string s;
+            DemangleSymbolTrees(argv[2], nargs == 4 ? std::filesystem::path(argv[3]) : std::filesystem::path());
+            return 0;
+        }
+        else if (firstArg == "--generate-corpus")
+        {
+            if (nargs < 4)
+            {
+                PrintUsage();
+                return 1;
+            }
 
-    s.reserve(length);
+            CorpusOptions options;
+            options.symbolCount = std::stoull(argv[3]);
 
-    while (length--)
-    {
-        s += chrs[pick(rg)];
-    }
+            for (int i = 4; i < nargs; i++)
+            {
+                const std::string_view arg = argv[i];
 
-    return s;
-}
+                if (arg.find('=') == std::string_view::npos)
+                {
+                    options.seed = std::stoull(argv[i]);
+                }
+                else
+                {
+                    SetCorpusOption(options, arg);
+                }
+            }
 
-static std::filesystem::path GetTemporaryFilePath()
-{
-    std::filesystem::path path = std::filesystem::temp_directory_path();;
-    path /= GetRandomFileName(8);
-    path.append(L".txt");
+            ThreadPool threadPool;
 
-    return path;
-}
+            const size_t replacedCount = GenerateCorpus(options, argv[2], threadPool);
 
-int main(int nargs, char* argv[])
-{
-    if (nargs <  2 || nargs > 3)
-    {
-        std::cout << "Usage SC3KLinuxDemangle input.txt [output.txt]\nThe output file is optional, when it is omitted the input file will be overwritten." << std::endl;
-        return 1;
-    }
+            std::cout << "Wrote " << options.symbolCount << " symbol(s), " << replacedCount << " generated name(s) were rejected by the demangler and replaced." << std::endl;
+            return 0;
+        }
 
-    try
-    {
-        bool overwriteInputFile = false;
+        if (nargs > 3)
+        {
+            PrintUsage();
+            return 1;
+        }
 
         const std::filesystem::path inputFile = argv[1];
-        std::filesystem::path outputFile;
 
         if (nargs == 3)
         {
-            outputFile = argv[2];
+            const std::filesystem::path outputFile = argv[2];
 
             if (inputFile.compare(outputFile) == 0)
             {
-                overwriteInputFile = true;
-                outputFile = GetTemporaryFilePath();
+                DemangleInputFileInPlace(inputFile);
+            }
+            else
+            {
+                DemangleInputFile(inputFile, outputFile);
             }
         }
         else
         {
-            overwriteInputFile = true;
-            outputFile = GetTemporaryFilePath();
-        }
-
-        DemangleInputFile(inputFile, outputFile);
-
-        if (overwriteInputFile)
-        {
-            std::filesystem::copy_file(outputFile, inputFile, std::filesystem::copy_options::overwrite_existing);
-            std::filesystem::remove(outputFile);
+            DemangleInputFileInPlace(inputFile);
         }
     }
     catch (const std::exception& e)
     {
         std::cout << e.what() << std::endl;
+
+        // The benchmark and verification modes are used as CI gates, an error such as a missing input must not pass.
+        return 1;
     }
 
     return 0;